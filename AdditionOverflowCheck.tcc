@@ -14,33 +14,36 @@
 #include <thread>
 #include <hash_map>
 #include <optional>
+#include <variant>
+#include <limits>
+#include <ranges>
+
+#include "ArithmeticMantissa.tcc"
+#include "Instrumentation.tcc"
+#include "ResultMask.tcc"
+#include "ThreadPool.tcc"
 
 
 template<typename N> requires std::is_arithmetic_v<N>
 class AdditionOverflowCheck {
 
-    static const
-    constinit auto
+    static constexpr auto
     pos_inf = std::numeric_limits<N>::infinity();
 
-    static const
-    constinit auto
-    neg_inf = std::minus<N>()(std::numeric_limits<N>::infinity());
-    static const
-    constinit auto
+    static constexpr auto
+    neg_inf = -std::numeric_limits<N>::infinity();
+
+    static constexpr auto
     nan = std::numeric_limits<N>::quiet_NaN();
 
-    static const
-    constinit auto
-    pos_inf_ptr = std::make_optional(pos_inf);
+    static constexpr auto
+    pos_inf_ptr = std::optional<N>(pos_inf);
 
-    static const
-    constinit auto
-    neg_inf_ptr = std::make_optional(neg_inf);
+    static constexpr auto
+    neg_inf_ptr = std::optional<N>(neg_inf);
 
-    static const
-    constinit auto
-    nan_ptr = std::make_optional(nan);
+    static constexpr auto
+    nan_ptr = std::optional<N>(nan);
 
 public:
 
@@ -62,6 +65,74 @@ public:
             }
         }
     }
+
+    static auto operator()(std::vector<N> const &lhs, std::vector<N> const &rhs) -> std::vector<bool> {
+        Instrumentation::ScopedTimer timer(Instrumentation::Timer::OverflowCheck);
+        auto n = static_cast<std::ptrdiff_t>(std::min(lhs.size(), rhs.size()));
+        std::vector<bool> result;
+        result.reserve(static_cast<std::size_t>(n));
+        std::transform(lhs.begin(), lhs.begin() + n, rhs.begin(), std::back_inserter(result),
+                       [](N lhs, N rhs) { return operator()(lhs, rhs); });
+        if constexpr (Instrumentation::enabled) {
+            Instrumentation::add(Instrumentation::Counter::ElementsChecked, result.size());
+            Instrumentation::add(Instrumentation::Counter::OverflowsFound, std::ranges::count(result, true));
+        }
+        return result;
+    }
+
+    static auto operator()(std::vector<N> const &lhs, N rhs) -> std::vector<bool> {
+        Instrumentation::ScopedTimer timer(Instrumentation::Timer::OverflowCheck);
+        std::vector<bool> result;
+        result.reserve(lhs.size());
+        std::transform(lhs.begin(), lhs.end(), std::back_inserter(result),
+                       [rhs](N lhs) { return operator()(lhs, rhs); });
+        if constexpr (Instrumentation::enabled) {
+            Instrumentation::add(Instrumentation::Counter::ElementsChecked, result.size());
+            Instrumentation::add(Instrumentation::Counter::OverflowsFound, std::ranges::count(result, true));
+        }
+        return result;
+    }
+
+    static auto operator()(N lhs, std::vector<N> const &rhs) -> std::vector<bool> {
+        return operator()(rhs, lhs);
+    }
+
+    /// @brief Bit-packed form of the vector operator(): same results, 64 per word
+    static auto mask(std::vector<N> const &lhs, std::vector<N> const &rhs) -> ResultMask {
+        Instrumentation::ScopedTimer timer(Instrumentation::Timer::OverflowCheck);
+        auto n = std::min(lhs.size(), rhs.size());
+        ResultMask result(n);
+        auto words = result.words();
+
+        /* Each task packs whole words, so no two threads ever write the same word */
+        constexpr std::size_t words_per_task = 256;
+        ThreadPool::shared().for_each_index((words.size() + words_per_task - 1) / words_per_task, [&](std::size_t t) {
+            auto last = std::min(words.size(), (t + 1) * words_per_task);
+            for (auto w = t * words_per_task; w < last; ++w) {
+                std::uint64_t word = 0;
+                auto base = w * 64;
+                auto bits = std::min<std::size_t>(64, n - base);
+                for (std::size_t b = 0; b < bits; ++b) {
+                    word |= std::uint64_t{operator()(lhs[base + b], rhs[base + b])} << b;
+                }
+                words[w] = word;
+            }
+        });
+        if constexpr (Instrumentation::enabled) {
+            Instrumentation::add(Instrumentation::Counter::ElementsChecked, n);
+            Instrumentation::add(Instrumentation::Counter::OverflowsFound, result.count());
+        }
+        return result;
+    }
+
+    /// @brief Exact integer sum, promoted to an ArithmeticMantissa instead of giving up when N would overflow
+    static auto promote(N lhs, N rhs) -> std::variant<N, ArithmeticMantissa<>> requires std::is_integral_v<N> {
+        N sum;
+        if (!__builtin_add_overflow(lhs, rhs, &sum)) {
+            return sum;
+        }
+        return ArithmeticMantissa<>(lhs) + ArithmeticMantissa<>(rhs);
+    }
 };
 
 
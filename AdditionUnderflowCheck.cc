@@ -1,6 +1,8 @@
 #include "AdditionUnderflowCheck.tcc"
 #include "PositiveInfinityQ.tcc"
 #include "NegativeInfinityQ.tcc"
+#include "Instrumentation.tcc"
+#include "ThreadPool.tcc"
 
 template<typename N>
 requires std::is_arithmetic_v<N>constexpr auto AdditionUnderflowCheck<N>::operator()(N lhs, N rhs) -> bool {
@@ -39,10 +41,15 @@ requires std::is_arithmetic_v<N>constexpr auto AdditionUnderflowCheck<N>::operat
 template<typename N>
 requires std::is_arithmetic_v<N>constexpr auto
 AdditionUnderflowCheck<N>::operator()(const std::vector<N> &lhs, N rhs) -> std::vector<bool> {
+    Instrumentation::ScopedTimer timer(Instrumentation::Timer::UnderflowCheck);
     std::vector<bool> result;
     result.reserve(lhs.size());
     std::transform(std::execution::par_unseq, lhs.begin(), lhs.end(), std::back_inserter(result),
                    [rhs](N lhs) { return operator()(lhs, rhs); });
+    if constexpr (Instrumentation::enabled) {
+        Instrumentation::add(Instrumentation::Counter::ElementsChecked, result.size());
+        Instrumentation::add(Instrumentation::Counter::UnderflowsFound, std::ranges::count(result, true));
+    }
     return result;
 }
 
@@ -50,10 +57,15 @@ AdditionUnderflowCheck<N>::operator()(const std::vector<N> &lhs, N rhs) -> std::
 template<typename N>
 requires std::is_arithmetic_v<N>constexpr auto
 AdditionUnderflowCheck<N>::operator()(const std::vector<N> &lhs, const std::vector<N> &rhs) -> std::vector<bool> {
+    Instrumentation::ScopedTimer timer(Instrumentation::Timer::UnderflowCheck);
     std::vector<bool> result;
     result.reserve(lhs.size());
     std::transform(std::execution::par_unseq, lhs.begin(), lhs.end(), rhs.begin(), std::back_inserter(result),
                    operator());
+    if constexpr (Instrumentation::enabled) {
+        Instrumentation::add(Instrumentation::Counter::ElementsChecked, result.size());
+        Instrumentation::add(Instrumentation::Counter::UnderflowsFound, std::ranges::count(result, true));
+    }
     return result;
 }
 
@@ -63,3 +75,33 @@ requires std::is_arithmetic_v<N>constexpr auto
 AdditionUnderflowCheck<N>::operator()(N lhs, const std::vector<N> &rhs) -> std::vector<bool> {
     return AdditionUnderflowCheck<N>::operator()(rhs, lhs);
 }
+
+
+template<typename N>
+requires std::is_arithmetic_v<N>auto
+AdditionUnderflowCheck<N>::mask(const std::vector<N> &lhs, const std::vector<N> &rhs) -> ResultMask {
+    Instrumentation::ScopedTimer timer(Instrumentation::Timer::UnderflowCheck);
+    auto n = std::min(lhs.size(), rhs.size());
+    ResultMask result(n);
+    auto words = result.words();
+
+    /* Each task packs whole words, so no two threads ever write the same word */
+    constexpr std::size_t words_per_task = 256;
+    ThreadPool::shared().for_each_index((words.size() + words_per_task - 1) / words_per_task, [&](std::size_t t) {
+        auto last = std::min(words.size(), (t + 1) * words_per_task);
+        for (auto w = t * words_per_task; w < last; ++w) {
+            std::uint64_t word = 0;
+            auto base = w * 64;
+            auto bits = std::min<std::size_t>(64, n - base);
+            for (std::size_t b = 0; b < bits; ++b) {
+                word |= std::uint64_t{operator()(lhs[base + b], rhs[base + b])} << b;
+            }
+            words[w] = word;
+        }
+    });
+    if constexpr (Instrumentation::enabled) {
+        Instrumentation::add(Instrumentation::Counter::ElementsChecked, n);
+        Instrumentation::add(Instrumentation::Counter::UnderflowsFound, result.count());
+    }
+    return result;
+}
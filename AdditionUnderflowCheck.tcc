@@ -15,21 +15,23 @@
 #include <ranges>
 #include <concepts>
 
+#include "ResultMask.tcc"
+
 template<typename N> requires std::is_arithmetic_v<N>
 class AdditionUnderflowCheck {
 
 private: /* Private Members */
 
     /// The positive infinity value for the given type N
-    static const constinit auto
+    static constexpr auto
     pos_inf = std::numeric_limits<N>::infinity();
 
     /// The negative infinity value for the given type N
-    static const constinit auto
-    neg_inf = std::minus<N>()(std::numeric_limits<N>::infinity());
+    static constexpr auto
+    neg_inf = -std::numeric_limits<N>::infinity();
 
     /// The NaN value for the given type N
-    static const constinit auto
+    static constexpr auto
     nan = std::numeric_limits<N>::quiet_NaN();
 
 public: /* Public Methods */
@@ -62,6 +64,9 @@ public: /* Public Methods */
 
     constexpr static auto operator()(N lhs, std::vector<N> const &rhs) -> std::vector<bool>;
 
+    /* static bit-packed vector method: same results as the vector operator(), 64 per word */
+    static auto mask(std::vector<N> const &lhs, std::vector<N> const &rhs) -> ResultMask;
+
 };
 
 
@@ -0,0 +1 @@
+#include "ArithmeticMantissa.tcc"
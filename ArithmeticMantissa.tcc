@@ -0,0 +1,382 @@
+#ifndef THREADED_ARITHMETIC_MANTISSA_TCC
+#define THREADED_ARITHMETIC_MANTISSA_TCC
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+/// @brief Arbitrary-precision signed integer stored as little-endian radix-2^64 limbs.
+///
+/// Values of up to inline_limbs limbs (every promoted 64- or 128-bit sum) live inside the object; longer
+/// values spill to the heap. Base is the radix used by to_digits()/to_string() when none is given.
+template<std::size_t Base = 2>
+class ArithmeticMantissa {
+
+    static_assert(Base >= 2 && Base <= 16, "ArithmeticMantissa digits are limited to the radices 2 through 16");
+
+public: /* Public types */
+
+    using Limb = std::uint64_t;
+
+private: /* Private types */
+
+    using Wide = unsigned __int128;
+
+private: /* Private Members */
+
+    /// Limbs kept inside the object before spilling to the heap
+    static constexpr std::size_t inline_limbs = 2;
+
+    /// Below this many limbs in the shorter operand Karatsuba loses to the schoolbook product
+    static constexpr std::size_t karatsuba_threshold = 32;
+
+    std::array<Limb, inline_limbs> m_inline{};
+    std::vector<Limb> m_heap{};
+    std::size_t m_size = 0;
+    bool m_negative = false;
+
+private: /* Private Methods */
+
+    auto data() noexcept -> Limb * { return m_heap.empty() ? m_inline.data() : m_heap.data(); }
+
+    auto data() const noexcept -> Limb const * { return m_heap.empty() ? m_inline.data() : m_heap.data(); }
+
+    auto resize(std::size_t n) -> void {
+        if (m_heap.empty() && n <= inline_limbs) {
+            std::fill(m_inline.begin() + static_cast<std::ptrdiff_t>(std::min(m_size, n)), m_inline.end(), 0);
+        } else {
+            if (m_heap.empty()) {
+                m_heap.assign(m_inline.begin(), m_inline.end());
+            }
+            m_heap.resize(std::max(n, inline_limbs), 0);
+        }
+        m_size = n;
+    }
+
+    /// @brief Drop leading zero limbs; zero is always non-negative
+    auto normalize() noexcept -> void {
+        auto *d = data();
+        while (m_size > 0 && d[m_size - 1] == 0) {
+            --m_size;
+        }
+        if (m_size == 0) {
+            m_negative = false;
+        }
+    }
+
+    auto limbs() const noexcept -> std::span<Limb const> { return {data(), m_size}; }
+
+    static auto compare_magnitude(std::span<Limb const> a, std::span<Limb const> b) noexcept -> std::strong_ordering {
+        if (a.size() != b.size()) {
+            return a.size() <=> b.size();
+        }
+        for (auto i = a.size(); i-- > 0;) {
+            if (a[i] != b[i]) {
+                return a[i] <=> b[i];
+            }
+        }
+        return std::strong_ordering::equal;
+    }
+
+    /// @brief out[0, n) += src, propagating the carry through out[0, n); returns the carry out of the top
+    static auto add_into(Limb *out, std::size_t n, Limb const *src, std::size_t m) noexcept -> Limb {
+        Limb carry = 0;
+        std::size_t i = 0;
+        for (; i < m; ++i) {
+            Wide s = Wide{out[i]} + src[i] + carry;
+            out[i] = static_cast<Limb>(s);
+            carry = static_cast<Limb>(s >> 64);
+        }
+        for (; carry && i < n; ++i) {
+            carry = ++out[i] == 0;
+        }
+        return carry;
+    }
+
+    /// @brief out[0, n) -= src where the result is known to be non-negative
+    static auto sub_into(Limb *out, std::size_t n, Limb const *src, std::size_t m) noexcept -> void {
+        Limb borrow = 0;
+        std::size_t i = 0;
+        for (; i < m; ++i) {
+            Wide d = Wide{out[i]} - src[i] - borrow;
+            out[i] = static_cast<Limb>(d);
+            borrow = static_cast<Limb>(d >> 64) & 1;
+        }
+        for (; borrow && i < n; ++i) {
+            borrow = out[i]-- == 0;
+        }
+    }
+
+    /// @brief out[0, na + nb) = a * b, O(na * nb)
+    static auto mul_schoolbook(Limb const *a, std::size_t na, Limb const *b, std::size_t nb, Limb *out) noexcept
+    -> void {
+        std::fill(out, out + na + nb, 0);
+        for (std::size_t i = 0; i < na; ++i) {
+            Limb carry = 0;
+            for (std::size_t j = 0; j < nb; ++j) {
+                Wide p = Wide{a[i]} * b[j] + out[i + j] + carry;
+                out[i + j] = static_cast<Limb>(p);
+                carry = static_cast<Limb>(p >> 64);
+            }
+            out[i + nb] = carry;
+        }
+    }
+
+    /// @brief out[0, na + nb) = a * b, Karatsuba once both operands reach the threshold
+    static auto mul_magnitude(Limb const *a, std::size_t na, Limb const *b, std::size_t nb, Limb *out) -> void {
+        if (na < nb) {
+            std::swap(a, b);
+            std::swap(na, nb);
+        }
+        if (nb < karatsuba_threshold) {
+            mul_schoolbook(a, na, b, nb, out);
+            return;
+        }
+
+        auto m = na / 2;
+
+        if (nb <= m) {
+            /* Unbalanced: split only the longer operand */
+            std::fill(out, out + na + nb, 0);
+            std::vector<Limb> t(std::max(m, na - m) + nb);
+            mul_magnitude(a, m, b, nb, t.data());
+            add_into(out, na + nb, t.data(), m + nb);
+            mul_magnitude(a + m, na - m, b, nb, t.data());
+            add_into(out + m, na + nb - m, t.data(), na - m + nb);
+            return;
+        }
+
+        /* a = a1 * B^m + a0, b = b1 * B^m + b0 */
+        auto na1 = na - m, nb1 = nb - m;
+
+        std::vector<Limb> sa(std::max(m, na1) + 1, 0), sb(std::max(m, nb1) + 1, 0);
+        std::copy_n(a, m, sa.begin());
+        add_into(sa.data(), sa.size(), a + m, na1);
+        std::copy_n(b, m, sb.begin());
+        add_into(sb.data(), sb.size(), b + m, nb1);
+
+        std::vector<Limb> z1(sa.size() + sb.size());
+        mul_magnitude(sa.data(), sa.size(), sb.data(), sb.size(), z1.data());
+
+        /* z0 and z2 land directly in their final place */
+        std::fill(out, out + na + nb, 0);
+        mul_magnitude(a, m, b, m, out);
+        mul_magnitude(a + m, na1, b + m, nb1, out + 2 * m);
+
+        /* z1 = (a0 + a1)(b0 + b1) - z0 - z2 */
+        sub_into(z1.data(), z1.size(), out, 2 * m);
+        sub_into(z1.data(), z1.size(), out + 2 * m, na1 + nb1);
+
+        auto z1_len = z1.size();
+        while (z1_len > 0 && z1[z1_len - 1] == 0) {
+            --z1_len;
+        }
+        add_into(out + m, na + nb - m, z1.data(), z1_len);
+    }
+
+    /// @brief |this| /= divisor, returning the remainder
+    auto divide_small(Limb divisor) noexcept -> Limb {
+        auto *d = data();
+        Wide rem = 0;
+        for (auto i = m_size; i-- > 0;) {
+            Wide cur = (rem << 64) | d[i];
+            d[i] = static_cast<Limb>(cur / divisor);
+            rem = cur % divisor;
+        }
+        auto negative = m_negative;
+        normalize();
+        m_negative = negative && m_size != 0;
+        return static_cast<Limb>(rem);
+    }
+
+    /// @brief this = sign * (|lhs| + |rhs|) or sign * (|lhs| - |rhs|) as dictated by the operand signs
+    auto add_signed(ArithmeticMantissa const &rhs, bool rhs_negative) -> ArithmeticMantissa & {
+        if (m_negative == rhs_negative) {
+            /* Read rhs's length before resizing: for x += x the resize changes it too */
+            auto m = rhs.m_size;
+            auto n = std::max(m_size, m);
+            resize(n + 1);
+            auto *d = data();
+            d[n] = add_into(d, n, rhs.data(), m);
+        } else if (compare_magnitude(limbs(), rhs.limbs()) != std::strong_ordering::less) {
+            sub_into(data(), m_size, rhs.data(), rhs.m_size);
+        } else {
+            ArithmeticMantissa result = rhs;
+            sub_into(result.data(), result.m_size, data(), m_size);
+            result.m_negative = rhs_negative;
+            *this = std::move(result);
+        }
+        normalize();
+        return *this;
+    }
+
+public: /* Constructors */
+
+    constexpr ArithmeticMantissa() noexcept = default;
+
+    /// @brief Exact value of any built-in integer, including the 128-bit ones (implicit, the conversion is lossless)
+    template<typename I> requires std::integral<I> || std::same_as<I, __int128> || std::same_as<I, unsigned __int128>
+    ArithmeticMantissa(I value) noexcept {
+        Wide magnitude;
+        if constexpr (std::is_signed_v<I> || std::same_as<I, __int128>) {
+            m_negative = value < 0;
+            magnitude = m_negative ? Wide{0} - static_cast<Wide>(value) : static_cast<Wide>(value);
+        } else {
+            magnitude = static_cast<Wide>(value);
+        }
+        m_inline = {static_cast<Limb>(magnitude), static_cast<Limb>(magnitude >> 64)};
+        m_size = inline_limbs;
+        normalize();
+    }
+
+public: /* Public Methods */
+
+    /// @brief Number of significant limbs (0 for zero)
+    auto size() const noexcept -> std::size_t { return m_size; }
+
+    auto is_negative() const noexcept -> bool { return m_negative; }
+
+    auto is_zero() const noexcept -> bool { return m_size == 0; }
+
+    /// @brief The value as T if it fits, std::nullopt otherwise
+    template<std::integral T>
+    auto to() const noexcept -> std::optional<T> {
+        if (m_size > 2) {
+            return std::nullopt;
+        }
+        Wide magnitude = 0;
+        for (auto i = m_size; i-- > 0;) {
+            magnitude = (magnitude << 64) | data()[i];
+        }
+        using U = std::make_unsigned_t<T>;
+        auto limit = static_cast<Wide>(std::numeric_limits<T>::max()) + (m_negative && std::is_signed_v<T>);
+        if (magnitude > limit || (m_negative && !std::is_signed_v<T> && magnitude != 0)) {
+            return std::nullopt;
+        }
+        auto bits = static_cast<U>(magnitude);
+        return static_cast<T>(m_negative ? static_cast<U>(U{0} - bits) : bits);
+    }
+
+    /// @brief Digits of |this| in the given radix, least significant first (same order as change_radix)
+    auto to_digits(std::size_t radix = Base) const -> std::vector<std::uint8_t> {
+        if (radix < 2 || radix > 16) {
+            throw std::invalid_argument("ArithmeticMantissa radix must be between 2 and 16");
+        }
+
+        std::vector<std::uint8_t> digits;
+        if (m_size == 0) {
+            digits.push_back(0);
+            return digits;
+        }
+
+        if (std::has_single_bit(radix)) {
+            /* Power-of-two radix: read digits straight out of the limbs */
+            auto bits = static_cast<std::size_t>(std::countr_zero(radix));
+            auto total = m_size * 64 - static_cast<std::size_t>(std::countl_zero(data()[m_size - 1]));
+            digits.reserve((total + bits - 1) / bits);
+            for (std::size_t pos = 0; pos < total; pos += bits) {
+                auto limb = pos / 64, shift = pos % 64;
+                auto value = data()[limb] >> shift;
+                if (shift + bits > 64 && limb + 1 < m_size) {
+                    value |= data()[limb + 1] << (64 - shift);
+                }
+                digits.push_back(static_cast<std::uint8_t>(value & (radix - 1)));
+            }
+            return digits;
+        }
+
+        /* Otherwise peel off as many digits per limb division as fit in 64 bits */
+        std::size_t per_chunk = 0;
+        Limb chunk = 1;
+        while (chunk <= std::numeric_limits<Limb>::max() / radix) {
+            chunk *= radix;
+            ++per_chunk;
+        }
+
+        ArithmeticMantissa rest = *this;
+        while (!rest.is_zero()) {
+            auto rem = rest.divide_small(chunk);
+            for (std::size_t i = 0; i < per_chunk && (rem != 0 || !rest.is_zero()); ++i) {
+                digits.push_back(static_cast<std::uint8_t>(rem % radix));
+                rem /= radix;
+            }
+        }
+        return digits;
+    }
+
+    /// @brief Signed textual form in the given radix, most significant digit first
+    auto to_string(std::size_t radix = Base) const -> std::string {
+        constexpr char symbols[] = "0123456789abcdef";
+        auto digits = to_digits(radix);
+        std::string text = m_negative ? "-" : "";
+        for (auto it = digits.rbegin(); it != digits.rend(); ++it) {
+            text.push_back(symbols[*it]);
+        }
+        return text;
+    }
+
+    auto operator-() const -> ArithmeticMantissa {
+        ArithmeticMantissa result = *this;
+        result.m_negative = !m_negative && m_size != 0;
+        return result;
+    }
+
+    auto operator+=(ArithmeticMantissa const &rhs) -> ArithmeticMantissa & { return add_signed(rhs, rhs.m_negative); }
+
+    auto operator-=(ArithmeticMantissa const &rhs) -> ArithmeticMantissa & {
+        return add_signed(rhs, !rhs.m_negative && rhs.m_size != 0);
+    }
+
+    auto operator*=(ArithmeticMantissa const &rhs) -> ArithmeticMantissa & {
+        *this = *this * rhs;
+        return *this;
+    }
+
+    friend auto operator+(ArithmeticMantissa lhs, ArithmeticMantissa const &rhs) -> ArithmeticMantissa {
+        return lhs += rhs;
+    }
+
+    friend auto operator-(ArithmeticMantissa lhs, ArithmeticMantissa const &rhs) -> ArithmeticMantissa {
+        return lhs -= rhs;
+    }
+
+    friend auto operator*(ArithmeticMantissa const &lhs, ArithmeticMantissa const &rhs) -> ArithmeticMantissa {
+        ArithmeticMantissa result;
+        if (lhs.is_zero() || rhs.is_zero()) {
+            return result;
+        }
+        result.resize(lhs.m_size + rhs.m_size);
+        mul_magnitude(lhs.data(), lhs.m_size, rhs.data(), rhs.m_size, result.data());
+        result.m_negative = lhs.m_negative != rhs.m_negative;
+        result.normalize();
+        return result;
+    }
+
+    friend auto operator==(ArithmeticMantissa const &lhs, ArithmeticMantissa const &rhs) noexcept -> bool {
+        return lhs.m_negative == rhs.m_negative && std::ranges::equal(lhs.limbs(), rhs.limbs());
+    }
+
+    friend auto operator<=>(ArithmeticMantissa const &lhs, ArithmeticMantissa const &rhs) noexcept
+    -> std::strong_ordering {
+        if (lhs.m_negative != rhs.m_negative) {
+            return lhs.m_negative ? std::strong_ordering::less : std::strong_ordering::greater;
+        }
+        auto order = compare_magnitude(lhs.limbs(), rhs.limbs());
+        return lhs.m_negative ? 0 <=> order : order;
+    }
+};
+
+
+#endif
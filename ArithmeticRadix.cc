@@ -0,0 +1 @@
+#include "ArithmeticRadix.tcc"
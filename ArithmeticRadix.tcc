@@ -0,0 +1,68 @@
+#ifndef THREADED_ARITHMETIC_RADIX_TCC
+#define THREADED_ARITHMETIC_RADIX_TCC
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+
+
+/// @brief Compile-time description of a positional digit base.
+///
+/// Algorithms that walk a value digit-by-digit (radix sort, radix conversion, ...) take the radix as a
+/// template parameter so the digit extraction collapses to a shift/mask when Base is a power of two.
+template<std::size_t Base = 2>
+class ArithmeticRadix {
+
+    static_assert(Base >= 2, "ArithmeticRadix requires a base of at least 2");
+
+public: /* Public Members */
+
+    /// The digit base
+    static constexpr std::size_t base = Base;
+
+    /// True when every digit is a fixed-width bit field
+    static constexpr bool power_of_two = std::has_single_bit(Base);
+
+    /// Width of one digit in bits (only meaningful when power_of_two)
+    static constexpr std::size_t digit_bits = power_of_two ? std::countr_zero(Base) : 0;
+
+public: /* Public Methods */
+
+    /// @brief Number of digits needed to represent every value of the unsigned type U
+    template<std::unsigned_integral U>
+    static constexpr auto digits() -> std::size_t {
+        if constexpr (power_of_two) {
+            return (std::numeric_limits<U>::digits + digit_bits - 1) / digit_bits;
+        } else {
+            std::size_t count = 1;
+            for (U value = std::numeric_limits<U>::max(); value >= Base; value /= Base) {
+                ++count;
+            }
+            return count;
+        }
+    }
+
+    /// @brief Base raised to the given digit position, i.e. the weight of that digit
+    template<std::unsigned_integral U>
+    static constexpr auto weight(std::size_t position) -> U {
+        U w = 1;
+        for (std::size_t i = 0; i < position; ++i) {
+            w *= static_cast<U>(Base);
+        }
+        return w;
+    }
+
+    /// @brief Extract the digit at the given position (0 is least significant)
+    template<std::unsigned_integral U>
+    static constexpr auto digit(U value, std::size_t position) -> std::size_t {
+        if constexpr (power_of_two) {
+            return static_cast<std::size_t>((value >> (position * digit_bits)) & static_cast<U>(Base - 1));
+        } else {
+            return static_cast<std::size_t>((value / weight<U>(position)) % static_cast<U>(Base));
+        }
+    }
+};
+
+
+#endif
@@ -0,0 +1 @@
+#include "Autotuner.tcc"
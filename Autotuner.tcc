@@ -0,0 +1,156 @@
+#ifndef THREADED_AUTOTUNER_TCC
+#define THREADED_AUTOTUNER_TCC
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "KernelPolicy.tcc"
+
+
+/// Policies tried by default: each parallelism level at the default tile, plus a larger tile and unroll
+using DefaultKernelPolicies = std::tuple<
+        KernelPolicy<Parallelism::Sequential>,
+        KernelPolicy<Parallelism::Simd>,
+        KernelPolicy<Parallelism::Simd, 4096, 8>,
+        KernelPolicy<Parallelism::Threaded>,
+        KernelPolicy<Parallelism::ThreadedSimd>,
+        KernelPolicy<Parallelism::ThreadedSimd, 65536, 8>
+>;
+
+
+/// @brief Picks the fastest policy instantiation of a kernel per problem size.
+///
+/// tune() times every policy in Policies for each requested size; select() maps a size to the winner of the
+/// largest tuned size not above it. Results round-trip through a plain text config, one
+/// "<kernel> <size> <policy name>" line per entry, so tuning can run once offline and be loaded at startup.
+template<typename Policies = DefaultKernelPolicies>
+class Autotuner {
+
+private: /* Private Members */
+
+    static constexpr std::size_t policy_count = std::tuple_size_v<Policies>;
+
+    /// Per kernel: problem size -> index into Policies
+    std::map<std::string, std::map<std::size_t, std::size_t>> m_table{};
+
+private: /* Private Methods */
+
+    template<std::size_t I>
+    using PolicyAt = std::tuple_element_t<I, Policies>;
+
+    static auto policy_name(std::size_t index) -> std::string {
+        return [index]<std::size_t... I>(std::index_sequence<I...>) {
+            std::string name;
+            ((index == I ? (name = PolicyAt<I>::name(), true) : false) || ...);
+            return name;
+        }(std::make_index_sequence<policy_count>{});
+    }
+
+    static auto policy_index(std::string const &name) -> std::optional<std::size_t> {
+        for (std::size_t i = 0; i < policy_count; ++i) {
+            if (policy_name(i) == name) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+public: /* Public Methods */
+
+    /// @brief Time bench.template operator()<Policy>(n) for every policy and size; keep the fastest.
+    /// @param repeats runs per measurement, the minimum is taken
+    template<typename Bench>
+    auto tune(std::string const &kernel, std::span<std::size_t const> sizes, Bench &&bench,
+              std::size_t repeats = 3) -> void {
+        for (auto n: sizes) {
+            auto best = std::numeric_limits<double>::infinity();
+            std::size_t winner = 0;
+
+            [&]<std::size_t... I>(std::index_sequence<I...>) {
+                ([&] {
+                    auto fastest = std::numeric_limits<double>::infinity();
+                    for (std::size_t r = 0; r < std::max<std::size_t>(repeats, 1); ++r) {
+                        auto start = std::chrono::steady_clock::now();
+                        bench.template operator()<PolicyAt<I>>(n);
+                        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                        fastest = std::min(fastest, elapsed.count());
+                    }
+                    if (fastest < best) {
+                        best = fastest;
+                        winner = I;
+                    }
+                }(), ...);
+            }(std::make_index_sequence<policy_count>{});
+
+            m_table[kernel][n] = winner;
+        }
+    }
+
+    /// @brief Index into Policies for a problem of size n; the first policy when the kernel was never tuned
+    auto select(std::string const &kernel, std::size_t n) const -> std::size_t {
+        auto found = m_table.find(kernel);
+        if (found == m_table.end() || found->second.empty()) {
+            return 0;
+        }
+        auto it = found->second.upper_bound(n);
+        return it == found->second.begin() ? it->second : std::prev(it)->second;
+    }
+
+    /// @brief Call fn.template operator()<Policy>() with the policy selected for (kernel, n)
+    template<typename F>
+    auto dispatch(std::string const &kernel, std::size_t n, F &&fn) const -> decltype(auto) {
+        using Result = decltype(fn.template operator()<PolicyAt<0>>());
+        auto index = select(kernel, n);
+
+        return [&]<std::size_t... I>(std::index_sequence<I...>) -> Result {
+            if constexpr (std::is_void_v<Result>) {
+                ((index == I ? (fn.template operator()<PolicyAt<I>>(), true) : false) || ...);
+            } else {
+                std::optional<Result> result;
+                ((index == I ? (result.emplace(fn.template operator()<PolicyAt<I>>()), true) : false) || ...);
+                return *std::move(result);
+            }
+        }(std::make_index_sequence<policy_count>{});
+    }
+
+    /// @return false if the file could not be written
+    auto save(std::string const &path) const -> bool {
+        std::ofstream out(path);
+        for (auto const &[kernel, sizes]: m_table) {
+            for (auto const &[n, index]: sizes) {
+                out << kernel << ' ' << n << ' ' << policy_name(index) << '\n';
+            }
+        }
+        return static_cast<bool>(out);
+    }
+
+    /// @brief Merge entries from a config written by save(); names of policies not in Policies are skipped
+    /// @return false if the file could not be read
+    auto load(std::string const &path) -> bool {
+        std::ifstream in(path);
+        if (!in) {
+            return false;
+        }
+        std::string kernel, name;
+        std::size_t n;
+        while (in >> kernel >> n >> name) {
+            if (auto index = policy_index(name)) {
+                m_table[kernel][n] = *index;
+            }
+        }
+        return true;
+    }
+};
+
+
+#endif
@@ -0,0 +1 @@
+#include "ConcurrentQueue.tcc"
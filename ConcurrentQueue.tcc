@@ -0,0 +1,257 @@
+#ifndef THREADED_CONCURRENT_QUEUE_TCC
+#define THREADED_CONCURRENT_QUEUE_TCC
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+
+enum class QueueMode : std::uint8_t {
+    MPMC = 0,
+    SPSC = 1,
+};
+
+
+/// @brief Bounded lock-free ring buffer; capacity is rounded up to a power of two.
+///
+/// MPMC follows Vyukov's design: every cell carries a sequence number that tells producers and consumers
+/// whether it is free, full, or still being written, so the only shared read-modify-writes are the CAS on the
+/// enqueue and dequeue positions. The positions sit on their own cache lines.
+///
+/// close() marks the end of the stream: producers must not push afterwards, and pop_batch() returns 0 only
+/// once the queue is both closed and empty.
+template<typename T, QueueMode Mode = QueueMode::MPMC> requires std::is_nothrow_move_constructible_v<T>
+class ConcurrentQueue {
+
+private: /* Private types */
+
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+private: /* Private Members */
+
+    static constexpr std::size_t line = 64;
+
+    std::size_t m_mask;
+    std::unique_ptr<Cell[]> m_cells;
+
+    alignas(line) std::atomic<std::size_t> m_enqueue{0};
+    alignas(line) std::atomic<std::size_t> m_dequeue{0};
+    alignas(line) std::atomic<bool> m_closed{false};
+
+public: /* Constructors */
+
+    explicit ConcurrentQueue(std::size_t capacity)
+            : m_mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+              m_cells(std::make_unique<Cell[]>(m_mask + 1)) {
+        for (std::size_t i = 0; i <= m_mask; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ConcurrentQueue(ConcurrentQueue const &) = delete;
+
+    ConcurrentQueue &operator=(ConcurrentQueue const &) = delete;
+
+    ~ConcurrentQueue() {
+        auto end = m_enqueue.load(std::memory_order_relaxed);
+        for (auto pos = m_dequeue.load(std::memory_order_relaxed); pos != end; ++pos) {
+            std::launder(reinterpret_cast<T *>(m_cells[pos & m_mask].storage))->~T();
+        }
+    }
+
+public: /* Public Methods */
+
+    auto capacity() const noexcept -> std::size_t { return m_mask + 1; }
+
+    /// @brief value is only moved from if the push succeeds
+    /// @return false if the queue is full
+    template<typename U = T> requires std::is_constructible_v<T, U &&>
+    auto try_push(U &&value) -> bool {
+        auto pos = m_enqueue.load(std::memory_order_relaxed);
+        for (;;) {
+            auto &cell = m_cells[pos & m_mask];
+            auto seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (m_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    ::new(cell.storage) T(std::forward<U>(value));
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_enqueue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// @return false if the queue is empty
+    auto try_pop(T &out) -> bool {
+        auto pos = m_dequeue.load(std::memory_order_relaxed);
+        for (;;) {
+            auto &cell = m_cells[pos & m_mask];
+            auto seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (m_dequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    auto *value = std::launder(reinterpret_cast<T *>(cell.storage));
+                    out = std::move(*value);
+                    value->~T();
+                    cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_dequeue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// @brief Spin (yielding) until there is room
+    auto push(T value) -> void {
+        while (!try_push(std::move(value))) {
+            std::this_thread::yield();
+        }
+    }
+
+    /// @brief Pop up to out.size() elements without waiting
+    /// @return the number of elements written to out
+    auto try_pop_batch(std::span<T> out) -> std::size_t {
+        std::size_t n = 0;
+        while (n < out.size() && try_pop(out[n])) {
+            ++n;
+        }
+        return n;
+    }
+
+    /// @brief Wait for at least one element, then pop up to out.size()
+    /// @return the number of elements written to out; 0 only once the queue is closed and drained
+    auto pop_batch(std::span<T> out) -> std::size_t {
+        for (;;) {
+            if (auto n = try_pop_batch(out)) {
+                return n;
+            }
+            if (m_closed.load(std::memory_order_acquire)) {
+                /* Pushes made before close() are visible now; one more look settles it */
+                return try_pop_batch(out);
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    auto close() noexcept -> void { m_closed.store(true, std::memory_order_release); }
+
+    auto closed() const noexcept -> bool { return m_closed.load(std::memory_order_acquire); }
+};
+
+
+/// @brief Single-producer single-consumer ring.
+///
+/// Each side owns one position and keeps a cached copy of the other side's, so the shared cache line is only
+/// read when the cached value says the ring looks full (producer) or empty (consumer). Batches are claimed
+/// with a single release store. Slots are default-constructed up front and move-assigned in place.
+template<typename T> requires std::is_nothrow_move_constructible_v<T>
+class ConcurrentQueue<T, QueueMode::SPSC> {
+
+private: /* Private Members */
+
+    static constexpr std::size_t line = 64;
+
+    std::size_t m_mask;
+    std::unique_ptr<T[]> m_slots;
+
+    /* Producer side */
+    alignas(line) std::atomic<std::size_t> m_tail{0};
+    std::size_t m_head_cache = 0;
+
+    /* Consumer side */
+    alignas(line) std::atomic<std::size_t> m_head{0};
+    std::size_t m_tail_cache = 0;
+
+    alignas(line) std::atomic<bool> m_closed{false};
+
+public: /* Constructors */
+
+    explicit ConcurrentQueue(std::size_t capacity)
+            : m_mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+              m_slots(std::make_unique<T[]>(m_mask + 1)) {}
+
+    ConcurrentQueue(ConcurrentQueue const &) = delete;
+
+    ConcurrentQueue &operator=(ConcurrentQueue const &) = delete;
+
+public: /* Public Methods */
+
+    auto capacity() const noexcept -> std::size_t { return m_mask + 1; }
+
+    template<typename U = T> requires std::is_assignable_v<T &, U &&>
+    auto try_push(U &&value) -> bool {
+        auto tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head_cache > m_mask) {
+            m_head_cache = m_head.load(std::memory_order_acquire);
+            if (tail - m_head_cache > m_mask) {
+                return false;
+            }
+        }
+        m_slots[tail & m_mask] = std::forward<U>(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    auto try_pop(T &out) -> bool {
+        return try_pop_batch(std::span<T>(&out, 1)) == 1;
+    }
+
+    auto push(T value) -> void {
+        while (!try_push(std::move(value))) {
+            std::this_thread::yield();
+        }
+    }
+
+    auto try_pop_batch(std::span<T> out) -> std::size_t {
+        auto head = m_head.load(std::memory_order_relaxed);
+        if (m_tail_cache == head) {
+            m_tail_cache = m_tail.load(std::memory_order_acquire);
+        }
+        auto n = std::min(out.size(), m_tail_cache - head);
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = std::move(m_slots[(head + i) & m_mask]);
+        }
+        if (n) {
+            m_head.store(head + n, std::memory_order_release);
+        }
+        return n;
+    }
+
+    auto pop_batch(std::span<T> out) -> std::size_t {
+        for (;;) {
+            if (auto n = try_pop_batch(out)) {
+                return n;
+            }
+            if (m_closed.load(std::memory_order_acquire)) {
+                return try_pop_batch(out);
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    auto close() noexcept -> void { m_closed.store(true, std::memory_order_release); }
+
+    auto closed() const noexcept -> bool { return m_closed.load(std::memory_order_acquire); }
+};
+
+
+#endif
@@ -0,0 +1 @@
+#include "CpuDispatch.tcc"
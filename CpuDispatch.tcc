@@ -0,0 +1,339 @@
+#ifndef THREADED_CPU_DISPATCH_TCC
+#define THREADED_CPU_DISPATCH_TCC
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#endif
+
+#include "ArithmeticRadix.tcc"
+#include "NPlus.tcc"
+
+
+/// Runtime selection between builds of the numeric kernels for different instruction set levels, so one
+/// binary compiled for baseline x86-64 or armv8-a still runs the wide loops on machines that have them.
+///
+/// Every kernel is instantiated once per level with [[gnu::target]] and [[gnu::flatten]], which recompiles the
+/// whole call tree below it for that level; calls go through a function pointer table indexed by active().
+/// The level can be pinned for A/B runs with force() or the THREADED_ISA environment variable
+/// (baseline, avx2, avx512, sve), clamped to what the CPU supports.
+namespace CpuDispatch {
+
+    enum class IsaLevel : std::uint8_t {
+        Baseline = 0,
+        Avx2 = 1,
+        Avx512 = 2,
+        Sve = 3,
+        Count = 4,
+    };
+
+    inline constexpr std::size_t level_count = static_cast<std::size_t>(IsaLevel::Count);
+
+    constexpr auto isa_name(IsaLevel level) -> char const * {
+        constexpr std::array<char const *, level_count> names = {"baseline", "avx2", "avx512", "sve"};
+        return names[static_cast<std::size_t>(level)];
+    }
+
+    constexpr auto parse_isa(std::string_view name) -> std::optional<IsaLevel> {
+        for (std::size_t i = 0; i < level_count; ++i) {
+            if (name == isa_name(static_cast<IsaLevel>(i))) {
+                return static_cast<IsaLevel>(i);
+            }
+        }
+        return std::nullopt;
+    }
+
+    /// @brief Best level this CPU (and OS) supports
+    inline auto detected() -> IsaLevel {
+        static auto const level = [] {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+                __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl")) {
+                return IsaLevel::Avx512;
+            }
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("bmi2")) {
+                return IsaLevel::Avx2;
+            }
+#elif defined(__aarch64__) && defined(__linux__) && defined(HWCAP_SVE)
+            if (getauxval(AT_HWCAP) & HWCAP_SVE) {
+                return IsaLevel::Sve;
+            }
+#endif
+            return IsaLevel::Baseline;
+        }();
+        return level;
+    }
+
+    /// @brief True if code built for level can run here (Avx512 implies Avx2; Sve is its own branch)
+    inline auto supported(IsaLevel level) -> bool {
+        auto best = detected();
+        if (level == IsaLevel::Baseline || level == best) {
+            return true;
+        }
+        return level == IsaLevel::Avx2 && best == IsaLevel::Avx512;
+    }
+
+    namespace detail {
+
+        inline auto initial_level() -> IsaLevel {
+            if (auto const *env = std::getenv("THREADED_ISA")) {
+                if (auto level = parse_isa(env); level && supported(*level)) {
+                    return *level;
+                }
+            }
+            return detected();
+        }
+
+        inline std::atomic<IsaLevel> forced{IsaLevel::Count};
+
+    }
+
+    /// @brief Level the kernels currently dispatch to
+    inline auto active() -> IsaLevel {
+        auto level = detail::forced.load(std::memory_order_relaxed);
+        if (level != IsaLevel::Count) {
+            return level;
+        }
+        static auto const initial = detail::initial_level();
+        return initial;
+    }
+
+    /// @brief Pin dispatch to level, or to the best supported level below it
+    /// @return the level actually in effect
+    inline auto force(IsaLevel level) -> IsaLevel {
+        if (!supported(level)) {
+            level = supported(IsaLevel::Avx2) && level == IsaLevel::Avx512 ? IsaLevel::Avx2 : IsaLevel::Baseline;
+        }
+        detail::forced.store(level, std::memory_order_relaxed);
+        return level;
+    }
+
+    /// @brief Undo force(); dispatch goes back to THREADED_ISA or the detected level
+    inline auto reset() -> void { detail::forced.store(IsaLevel::Count, std::memory_order_relaxed); }
+
+    /// @brief The level force() pinned, or nullopt while dispatch follows THREADED_ISA or the detected level
+    inline auto forced() -> std::optional<IsaLevel> {
+        auto level = detail::forced.load(std::memory_order_relaxed);
+        return level == IsaLevel::Count ? std::nullopt : std::optional(level);
+    }
+
+    /// @brief Put back what forced() returned: pin that level again, or reset() for nullopt
+    inline auto restore(std::optional<IsaLevel> level) -> void {
+        detail::forced.store(level.value_or(IsaLevel::Count), std::memory_order_relaxed);
+    }
+
+    namespace detail {
+
+        template<typename T>
+        constexpr auto finite(T n) -> bool {
+            if constexpr (std::is_integral_v<T>) {
+                return true;
+            } else {
+                return std::abs(n) <= std::numeric_limits<T>::max();
+            }
+        }
+
+        /// Either operand is not finite, or the sum leaves the range upward (Up) or downward (!Up)
+        template<bool Up, typename T>
+        auto addition_check(T const *lhs, T const *rhs, std::uint8_t *flags, std::size_t n) -> std::size_t {
+            using Add = NPlus<T, OverflowPolicy::Wrap>;
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                auto sum = Add::wrapping_add(lhs[i], rhs[i]);
+                bool direction;
+                if constexpr (std::is_integral_v<T>) {
+                    direction = Up ? rhs[i] > 0 : rhs[i] < 0;
+                } else {
+                    direction = Up ? sum > 0 : sum < 0;
+                }
+                bool special = !(finite(lhs[i]) && finite(rhs[i]));
+                bool flag = special | (Add::overflowed(lhs[i], rhs[i], sum) & direction);
+                flags[i] = flag;
+                count += flag;
+            }
+            return count;
+        }
+
+        template<bool Positive, typename T>
+        auto infinity_check(T const *in, std::uint8_t *flags, std::size_t n) -> std::size_t {
+            constexpr auto inf = Positive ? std::numeric_limits<T>::infinity() : -std::numeric_limits<T>::infinity();
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                bool flag = std::is_floating_point_v<T> && in[i] == inf;
+                flags[i] = flag;
+                count += flag;
+            }
+            return count;
+        }
+
+        template<typename T, OverflowPolicy Policy>
+        auto nplus(T const *lhs, T const *rhs, typename NPlus<T, Policy>::result_type *out, std::size_t n)
+        -> std::size_t {
+            return NPlus<T, Policy>{}(std::span<T const>(lhs, n), std::span<T const>(rhs, n),
+                                      std::span<typename NPlus<T, Policy>::result_type>(out, n));
+        }
+
+        template<typename Radix, typename U>
+        auto radix_digits(U const *values, std::size_t position, U *out, std::size_t n) -> void {
+            for (std::size_t i = 0; i < n; ++i) {
+                out[i] = static_cast<U>(Radix::digit(values[i], position));
+            }
+        }
+
+    }
+
+    /* One copy of every kernel entry point per level; the macro arguments are the attributes selecting the ISA */
+#define THREADED_CPU_DISPATCH_KERNELS(...)                                                                         \
+    template<bool Up, typename T>                                                                                  \
+    __VA_ARGS__ static auto addition_check(T const *lhs, T const *rhs, std::uint8_t *flags, std::size_t n)          \
+    -> std::size_t { return detail::addition_check<Up>(lhs, rhs, flags, n); }                                      \
+                                                                                                                   \
+    template<bool Positive, typename T>                                                                            \
+    __VA_ARGS__ static auto infinity_check(T const *in, std::uint8_t *flags, std::size_t n) -> std::size_t {        \
+        return detail::infinity_check<Positive>(in, flags, n);                                                     \
+    }                                                                                                              \
+                                                                                                                   \
+    template<typename T, OverflowPolicy Policy>                                                                    \
+    __VA_ARGS__ static auto nplus(T const *lhs, T const *rhs, typename NPlus<T, Policy>::result_type *out,          \
+                                 std::size_t n) -> std::size_t {                                                   \
+        return detail::nplus<T, Policy>(lhs, rhs, out, n);                                                         \
+    }                                                                                                              \
+                                                                                                                   \
+    template<typename Radix, typename U>                                                                           \
+    __VA_ARGS__ static auto radix_digits(U const *values, std::size_t position, U *out, std::size_t n) -> void {    \
+        detail::radix_digits<Radix>(values, position, out, n);                                                     \
+    }
+
+    /// @brief Kernel entry points compiled for one level; levels foreign to the target fall back to baseline
+    template<IsaLevel Level>
+    struct Isa {
+        THREADED_CPU_DISPATCH_KERNELS()
+    };
+
+#if defined(__x86_64__) || defined(__i386__)
+    template<>
+    struct Isa<IsaLevel::Avx2> {
+        THREADED_CPU_DISPATCH_KERNELS([[gnu::flatten, gnu::target("avx2,fma,bmi,bmi2,lzcnt,popcnt")]])
+    };
+
+    template<>
+    struct Isa<IsaLevel::Avx512> {
+        THREADED_CPU_DISPATCH_KERNELS(
+                [[gnu::flatten, gnu::target("avx512f,avx512bw,avx512dq,avx512vl,avx2,fma,bmi,bmi2,lzcnt,popcnt")]])
+    };
+#elif defined(__aarch64__)
+    template<>
+    struct Isa<IsaLevel::Sve> {
+        THREADED_CPU_DISPATCH_KERNELS([[gnu::flatten, gnu::target("+sve")]])
+    };
+#endif
+
+#undef THREADED_CPU_DISPATCH_KERNELS
+
+    namespace detail {
+
+        /// @brief Function pointer table over all levels for the entry point Select picks out of Isa<Level>
+        template<typename Fn, typename Select, std::size_t... I>
+        constexpr auto make_table(Select select, std::index_sequence<I...>) -> std::array<Fn *, level_count> {
+            return {select.template operator()<Isa<static_cast<IsaLevel>(I)>>()...};
+        }
+
+        template<typename Fn, typename Select>
+        constexpr auto table(Select select) -> std::array<Fn *, level_count> {
+            return make_table<Fn>(select, std::make_index_sequence<level_count>{});
+        }
+
+        inline auto level_index() -> std::size_t { return static_cast<std::size_t>(active()); }
+
+    }
+
+    /// @brief flags[i] = 1 where lhs[i] + rhs[i] overflows upward or an operand is infinite or NaN
+    /// (the batch form of AdditionOverflowCheck)
+    /// @return the number of flagged lanes
+    template<typename T> requires std::is_arithmetic_v<T>
+    auto overflow_check(std::span<T const> lhs, std::span<T const> rhs, std::span<std::uint8_t> flags)
+    -> std::size_t {
+        using Fn = auto(T const *, T const *, std::uint8_t *, std::size_t) -> std::size_t;
+        static constexpr auto kernels = detail::table<Fn>([]<typename I>() {
+            return &I::template addition_check<true, T>;
+        });
+        return kernels[detail::level_index()](lhs.data(), rhs.data(), flags.data(),
+                                              std::min({lhs.size(), rhs.size(), flags.size()}));
+    }
+
+    /// @brief flags[i] = 1 where lhs[i] + rhs[i] overflows downward or an operand is infinite or NaN
+    /// (the batch form of AdditionUnderflowCheck)
+    /// @return the number of flagged lanes
+    template<typename T> requires std::is_arithmetic_v<T>
+    auto underflow_check(std::span<T const> lhs, std::span<T const> rhs, std::span<std::uint8_t> flags)
+    -> std::size_t {
+        using Fn = auto(T const *, T const *, std::uint8_t *, std::size_t) -> std::size_t;
+        static constexpr auto kernels = detail::table<Fn>([]<typename I>() {
+            return &I::template addition_check<false, T>;
+        });
+        return kernels[detail::level_index()](lhs.data(), rhs.data(), flags.data(),
+                                              std::min({lhs.size(), rhs.size(), flags.size()}));
+    }
+
+    /// @brief flags[i] = 1 where in[i] is +infinity (the batch form of Predicates::PositiveInfinityQ)
+    /// @return the number of flagged lanes
+    template<typename T> requires std::is_arithmetic_v<T>
+    auto positive_infinity(std::span<T const> in, std::span<std::uint8_t> flags) -> std::size_t {
+        using Fn = auto(T const *, std::uint8_t *, std::size_t) -> std::size_t;
+        static constexpr auto kernels = detail::table<Fn>([]<typename I>() {
+            return &I::template infinity_check<true, T>;
+        });
+        return kernels[detail::level_index()](in.data(), flags.data(), std::min(in.size(), flags.size()));
+    }
+
+    /// @brief flags[i] = 1 where in[i] is -infinity (the batch form of Predicates::NegativeInfinityQ)
+    /// @return the number of flagged lanes
+    template<typename T> requires std::is_arithmetic_v<T>
+    auto negative_infinity(std::span<T const> in, std::span<std::uint8_t> flags) -> std::size_t {
+        using Fn = auto(T const *, std::uint8_t *, std::size_t) -> std::size_t;
+        static constexpr auto kernels = detail::table<Fn>([]<typename I>() {
+            return &I::template infinity_check<false, T>;
+        });
+        return kernels[detail::level_index()](in.data(), flags.data(), std::min(in.size(), flags.size()));
+    }
+
+    /// @brief NPlus<T, Policy> batch addition built for the active level
+    /// @return the number of lanes that took the slow path
+    template<typename T, OverflowPolicy Policy = default_overflow_policy<T>> requires std::is_arithmetic_v<T>
+    auto nplus(std::span<T const> lhs, std::span<T const> rhs, std::span<typename NPlus<T, Policy>::result_type> out)
+    -> std::size_t {
+        using Fn = auto(T const *, T const *, typename NPlus<T, Policy>::result_type *, std::size_t) -> std::size_t;
+        static constexpr auto kernels = detail::table<Fn>([]<typename I>() {
+            return &I::template nplus<T, Policy>;
+        });
+        return kernels[detail::level_index()](lhs.data(), rhs.data(), out.data(),
+                                              std::min({lhs.size(), rhs.size(), out.size()}));
+    }
+
+    /// @brief out[i] = digit of values[i] at position in Radix
+    template<typename Radix, std::unsigned_integral U>
+    auto radix_digits(std::span<U const> values, std::size_t position, std::span<U> out) -> void {
+        using Fn = auto(U const *, std::size_t, U *, std::size_t) -> void;
+        static constexpr auto kernels = detail::table<Fn>([]<typename I>() {
+            return &I::template radix_digits<Radix, U>;
+        });
+        kernels[detail::level_index()](values.data(), position, out.data(), std::min(values.size(), out.size()));
+    }
+}
+
+
+#endif
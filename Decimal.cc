@@ -0,0 +1 @@
+#include "Decimal.tcc"
@@ -0,0 +1,375 @@
+#ifndef THREADED_DECIMAL_TCC
+#define THREADED_DECIMAL_TCC
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "ArithmeticRadix.tcc"
+#include "RadixParse.tcc"
+
+
+namespace DecimalDetail {
+
+    constexpr auto pow10(std::size_t n) -> unsigned __int128 {
+        unsigned __int128 p = 1;
+        for (std::size_t i = 0; i < n; ++i) {
+            p *= 10;
+        }
+        return p;
+    }
+
+    /// @brief Round-half-even x / 10^K for x of either sign
+    template<std::size_t K, typename W>
+    constexpr auto divide_pow10(W x) noexcept -> W {
+        static_assert(K <= 38, "divide_pow10: 10^K must fit in 128 bits");
+        using U = std::conditional_t<sizeof(W) <= 8, std::uint64_t, unsigned __int128>;
+        if constexpr (K == 0) {
+            return x;
+        } else if constexpr (sizeof(U) == 8 && K > 19) {
+            /* Every 64-bit magnitude is below half of 10^20, so the quotient rounds to zero */
+            return W{0};
+        } else {
+            bool negative = x < 0;
+            auto magnitude = negative ? U{0} - static_cast<U>(x) : static_cast<U>(x);
+            U q;
+            U r;
+
+            /* Fast path: a 64-bit dividend and a constant divisor, which compiles to a multiply-shift; 10^19 is
+               the largest power of ten a 64-bit divisor can hold */
+            if constexpr (K <= 19) {
+                if (magnitude <= std::numeric_limits<std::uint64_t>::max()) {
+                    constexpr auto d = static_cast<std::uint64_t>(pow10(K));
+                    auto m = static_cast<std::uint64_t>(magnitude);
+                    q = m / d;
+                    r = m % d;
+                } else {
+                    constexpr auto d = static_cast<U>(pow10(K));
+                    q = magnitude / d;
+                    r = magnitude % d;
+                }
+            } else {
+                constexpr auto d = static_cast<U>(pow10(K));
+                q = magnitude / d;
+                r = magnitude % d;
+            }
+            constexpr auto half = static_cast<U>(pow10(K) / 2);
+            q += (r > half) | ((r == half) & (q & 1));
+            return negative ? static_cast<W>(U{0} - q) : static_cast<W>(q);
+        }
+    }
+}
+
+
+/// @brief Fixed-point decimal with Digits significant digits, Scale of them after the point.
+///
+/// The value is stored as an integer count of 10^-Scale units (int64 up to 18 digits, __int128 up to 38), so
+/// addition and subtraction are exact integer operations checked with __builtin_*_overflow and against the
+/// digit limit. Multiplication rounds half to even back to Scale; when the double-width product fits in 64
+/// bits the division is by a compile-time constant 10^Scale, which the compiler turns into a multiply-shift.
+template<std::size_t Digits, std::size_t Scale>
+requires (Digits >= 1 && Digits <= 38 && Scale <= Digits)
+class Decimal {
+
+public: /* Public types */
+
+    using Storage = std::conditional_t<(Digits <= 18), std::int64_t, __int128>;
+
+private: /* Private types */
+
+    /// Wide enough for the product of two Storage values when Storage is int64
+    using Wide = __int128;
+
+    static constexpr auto pow10(std::size_t n) -> unsigned __int128 { return DecimalDetail::pow10(n); }
+
+public: /* Public Members */
+
+    static constexpr Storage one = static_cast<Storage>(pow10(Scale));
+
+    /// Largest representable unit count, 10^Digits - 1
+    static constexpr Storage max_units = static_cast<Storage>(pow10(Digits) - 1);
+
+private: /* Private Members */
+
+    Storage m_units = 0;
+
+private: /* Private Methods */
+
+    static constexpr auto in_range(Storage units) noexcept -> bool { return units <= max_units && units >= -max_units; }
+
+    template<typename W>
+    static constexpr auto rescale_down(W x) noexcept -> W { return DecimalDetail::divide_pow10<Scale>(x); }
+
+    /// @brief The digits of a magnitude, most significant first, through ArithmeticRadix<10>
+    static auto digit_string(unsigned __int128 magnitude) -> std::string {
+        /* Split into 10^18 chunks so every chunk is a 64-bit value ArithmeticRadix can walk */
+        constexpr auto chunk_digits = std::size_t{18};
+        constexpr auto chunk = static_cast<std::uint64_t>(pow10(chunk_digits));
+        std::uint64_t parts[3] = {};
+        std::size_t count = 0;
+        do {
+            parts[count++] = static_cast<std::uint64_t>(magnitude % chunk);
+            magnitude /= chunk;
+        } while (magnitude != 0);
+
+        std::string text;
+        for (std::size_t p = count; p-- > 0;) {
+            auto width = p + 1 == count ? ArithmeticRadix<10>::digits<std::uint64_t>() : chunk_digits;
+            bool leading = p + 1 == count;
+            for (std::size_t d = width; d-- > 0;) {
+                auto digit = ArithmeticRadix<10>::digit<std::uint64_t>(parts[p], d);
+                if (leading && digit == 0 && d != 0) {
+                    continue;
+                }
+                leading = false;
+                text.push_back(static_cast<char>('0' + digit));
+            }
+        }
+        return text;
+    }
+
+public: /* Constructors */
+
+    constexpr Decimal() noexcept = default;
+
+    /// @brief The whole number value; throws std::overflow_error beyond Digits - Scale integer digits
+    template<std::integral I>
+    constexpr explicit Decimal(I whole) {
+        Storage units;
+        if (__builtin_mul_overflow(whole, one, &units) || !in_range(units)) {
+            throw std::overflow_error("Decimal: value out of range");
+        }
+        m_units = units;
+    }
+
+    /// @brief From a count of 10^-Scale units, nullopt beyond Digits digits
+    static constexpr auto from_units(Storage units) noexcept -> std::optional<Decimal> {
+        if (!in_range(units)) {
+            return std::nullopt;
+        }
+        Decimal d;
+        d.m_units = units;
+        return d;
+    }
+
+public: /* Public Methods */
+
+    constexpr auto units() const noexcept -> Storage { return m_units; }
+
+    constexpr auto to_double() const noexcept -> double {
+        return static_cast<double>(m_units) / static_cast<double>(one);
+    }
+
+    static constexpr auto checked_add(Decimal lhs, Decimal rhs) noexcept -> std::optional<Decimal> {
+        Storage units;
+        if (__builtin_add_overflow(lhs.m_units, rhs.m_units, &units)) {
+            return std::nullopt;
+        }
+        return from_units(units);
+    }
+
+    static constexpr auto checked_sub(Decimal lhs, Decimal rhs) noexcept -> std::optional<Decimal> {
+        Storage units;
+        if (__builtin_sub_overflow(lhs.m_units, rhs.m_units, &units)) {
+            return std::nullopt;
+        }
+        return from_units(units);
+    }
+
+    /// @brief Product rounded half to even to Scale. With 128-bit storage the unrounded product must fit
+    /// in 127 bits, even when the rounded result would be representable.
+    static constexpr auto checked_mul(Decimal lhs, Decimal rhs) noexcept -> std::optional<Decimal> {
+        Wide product;
+        if (__builtin_mul_overflow(static_cast<Wide>(lhs.m_units), static_cast<Wide>(rhs.m_units), &product)) {
+            return std::nullopt;
+        }
+        auto units = rescale_down(product);
+        if (units > static_cast<Wide>(max_units) || units < -static_cast<Wide>(max_units)) {
+            return std::nullopt;
+        }
+        return from_units(static_cast<Storage>(units));
+    }
+
+    /// @brief The same value at another precision, rounding half to even when Scale shrinks
+    template<std::size_t D2, std::size_t S2>
+    constexpr auto rescale() const noexcept -> std::optional<Decimal<D2, S2>> {
+        using Target = Decimal<D2, S2>;
+        Wide units = m_units;
+        if constexpr (S2 > Scale) {
+            if (__builtin_mul_overflow(units, static_cast<Wide>(pow10(S2 - Scale)), &units)) {
+                return std::nullopt;
+            }
+        } else if constexpr (S2 < Scale) {
+            units = DecimalDetail::divide_pow10<Scale - S2>(units);
+        }
+        if (units > static_cast<Wide>(Target::max_units) || units < -static_cast<Wide>(Target::max_units)) {
+            return std::nullopt;
+        }
+        return Target::from_units(static_cast<typename Target::Storage>(units));
+    }
+
+    constexpr auto operator-() const noexcept -> Decimal {
+        Decimal d;
+        d.m_units = -m_units;
+        return d;
+    }
+
+    /* Throwing operators over the checked forms */
+
+    friend constexpr auto operator+(Decimal lhs, Decimal rhs) -> Decimal {
+        if (auto sum = checked_add(lhs, rhs)) {
+            return *sum;
+        }
+        throw std::overflow_error("Decimal: addition overflow");
+    }
+
+    friend constexpr auto operator-(Decimal lhs, Decimal rhs) -> Decimal {
+        if (auto difference = checked_sub(lhs, rhs)) {
+            return *difference;
+        }
+        throw std::overflow_error("Decimal: subtraction overflow");
+    }
+
+    friend constexpr auto operator*(Decimal lhs, Decimal rhs) -> Decimal {
+        if (auto product = checked_mul(lhs, rhs)) {
+            return *product;
+        }
+        throw std::overflow_error("Decimal: multiplication overflow");
+    }
+
+    friend constexpr auto operator<=>(Decimal const &, Decimal const &) noexcept = default;
+
+    /// @brief "[-]digits[.digits]", always with exactly Scale fraction digits
+    auto to_string() const -> std::string {
+        auto negative = m_units < 0;
+        using U = std::conditional_t<(Digits <= 18), std::uint64_t, unsigned __int128>;
+        auto magnitude = negative ? U{0} - static_cast<U>(m_units) : static_cast<U>(m_units);
+        auto text = digit_string(magnitude);
+        if constexpr (Scale > 0) {
+            if (text.size() <= Scale) {
+                text.insert(0, Scale + 1 - text.size(), '0');
+            }
+            text.insert(text.size() - Scale, 1, '.');
+        }
+        return negative ? "-" + text : text;
+    }
+
+    /// @brief Parse "[-]digits[.digits]"; non-zero fraction digits beyond Scale are reported as Overflow rather
+    /// than silently rounded
+    static auto parse(std::string_view text, Decimal &value) -> ParseStatus {
+        if (text.empty()) {
+            return ParseStatus::Empty;
+        }
+        bool negative = text.front() == '-';
+        if (negative) {
+            text.remove_prefix(1);
+        }
+        auto point = text.find('.');
+        auto whole = text.substr(0, point);
+        auto fraction = point == std::string_view::npos ? std::string_view{} : text.substr(point + 1);
+        if (whole.empty() && fraction.empty()) {
+            return ParseStatus::InvalidDigit;
+        }
+        if (fraction.size() > Scale) {
+            if (fraction.substr(Scale).find_first_not_of('0') != std::string_view::npos) {
+                return fraction.substr(Scale).find_first_not_of("0123456789") != std::string_view::npos
+                       ? ParseStatus::InvalidDigit : ParseStatus::Overflow;
+            }
+            fraction = fraction.substr(0, Scale);
+        }
+
+        /* Whole digits then fraction digits padded to Scale, folded 18 at a time through RadixParse */
+        unsigned __int128 units = 0;
+        bool overflow = false;
+        auto fold = [&](std::string_view digits) -> ParseStatus {
+            for (std::size_t at = 0; at < digits.size(); at += 18) {
+                auto piece = digits.substr(at, 18);
+                std::uint64_t part = 0;
+                if (auto status = RadixParse<std::uint64_t>{}(piece, 10, part); status != ParseStatus::Ok) {
+                    return status;
+                }
+                overflow |= units > static_cast<unsigned __int128>(max_units) / pow10(piece.size());
+                units = units * pow10(piece.size()) + part;
+            }
+            return ParseStatus::Ok;
+        };
+        if (auto status = fold(whole); status != ParseStatus::Ok) {
+            return status;
+        }
+        if (auto status = fold(fraction); status != ParseStatus::Ok) {
+            return status;
+        }
+        if (overflow || units > static_cast<unsigned __int128>(max_units) / pow10(Scale - fraction.size())) {
+            return ParseStatus::Overflow;
+        }
+        units *= pow10(Scale - fraction.size());
+
+        value.m_units = negative ? -static_cast<Storage>(units) : static_cast<Storage>(units);
+        return ParseStatus::Ok;
+    }
+
+    /* Batch kernels: branch-free lane loops; overflowed lanes saturate to +-max and are flagged */
+
+    /// @return the number of lanes that overflowed
+    static auto add(std::span<Decimal const> lhs, std::span<Decimal const> rhs, std::span<Decimal> out,
+                    std::span<std::uint8_t> flags = {}) -> std::size_t {
+        return batch(lhs, rhs, out, flags, [](Storage a, Storage b, Storage &r) -> int {
+            bool wrapped = __builtin_add_overflow(a, b, &r);
+            bool negative = wrapped ? a < 0 : r < 0;
+            return (wrapped || !in_range(r)) * (negative ? -1 : 1);
+        });
+    }
+
+    static auto sub(std::span<Decimal const> lhs, std::span<Decimal const> rhs, std::span<Decimal> out,
+                    std::span<std::uint8_t> flags = {}) -> std::size_t {
+        return batch(lhs, rhs, out, flags, [](Storage a, Storage b, Storage &r) -> int {
+            bool wrapped = __builtin_sub_overflow(a, b, &r);
+            bool negative = wrapped ? a < 0 : r < 0;
+            return (wrapped || !in_range(r)) * (negative ? -1 : 1);
+        });
+    }
+
+    static auto mul(std::span<Decimal const> lhs, std::span<Decimal const> rhs, std::span<Decimal> out,
+                    std::span<std::uint8_t> flags = {}) -> std::size_t {
+        return batch(lhs, rhs, out, flags, [](Storage a, Storage b, Storage &r) -> int {
+            Wide product;
+            bool wrapped = __builtin_mul_overflow(static_cast<Wide>(a), static_cast<Wide>(b), &product);
+            auto units = rescale_down(product);
+            bool fits = !wrapped && units <= static_cast<Wide>(max_units) && units >= -static_cast<Wide>(max_units);
+            r = static_cast<Storage>(units);
+            return !fits * (((a < 0) != (b < 0)) ? -1 : 1);
+        });
+    }
+
+private: /* Private Methods */
+
+    /// @brief op(a, b, r) stores the lane result in r and returns 0, or the sign of the exact result if it
+    /// is out of range
+    template<typename Op>
+    static auto batch(std::span<Decimal const> lhs, std::span<Decimal const> rhs, std::span<Decimal> out,
+                      std::span<std::uint8_t> flags, Op &&op) -> std::size_t {
+        auto n = std::min({lhs.size(), rhs.size(), out.size()});
+        std::size_t overflowed = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            Storage r;
+            auto direction = op(lhs[i].m_units, rhs[i].m_units, r);
+            out[i].m_units = direction == 0 ? r : direction > 0 ? max_units : -max_units;
+            overflowed += direction != 0;
+            if (!flags.empty() && i < flags.size()) {
+                flags[i] = direction != 0;
+            }
+        }
+        return overflowed;
+    }
+};
+
+
+#endif
@@ -0,0 +1 @@
+#include "Differential.tcc"
@@ -0,0 +1,430 @@
+#ifndef THREADED_DIFFERENTIAL_TCC
+#define THREADED_DIFFERENTIAL_TCC
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Autotuner.tcc"
+#include "CpuDispatch.tcc"
+#include "NPlus.tcc"
+#include "Pipeline.tcc"
+
+
+/// Differential checking of the optimized addition kernels against their scalar definitions.
+///
+/// check() runs every variant this build can execute, meaning each CpuDispatch level the CPU supports,
+/// each Kernels<> instantiation of DefaultKernelPolicies, and the fused and staged Pipeline. It compares
+/// every output lane bit for bit with a scalar reference (a NaN sum may carry either NaN operand's payload),
+/// and times each variant on the same inputs, so one run reports correctness and throughput regressions
+/// together. adversarial() generates inputs aimed at
+/// the edges: every pair of the edge values (±0, ±max, ±inf, NaNs with payloads, subnormals, min/max
+/// integers), then random pairs biased towards the overflow boundary. Identical seeds give identical inputs,
+/// so a reported mismatch index can be reproduced.
+///
+/// The flag references are the documented batch semantics built on overflows(), which decides overflow
+/// without NPlus (__builtin_add_overflow, or an exact sum in a wider type): upward()/downward() for
+/// CpuDispatch::overflow_check/underflow_check, either() for Pipeline::check_range and overflows() itself for
+/// Kernels::will_overflow. Sums are checked against the scalar NPlus<T, Policy>::safe_add.
+namespace Differential {
+
+    /// Arithmetic types the generator knows the bit layout of
+    template<typename T>
+    concept Checkable = (std::integral<T> && !std::same_as<T, bool>) ||
+                        (std::floating_point<T> && (sizeof(T) == 4 || sizeof(T) == 8));
+
+    template<Checkable T>
+    inline constexpr auto default_policy = default_overflow_policy<T>;
+
+    /// @brief Outcome for one kernel variant; first_mismatch is npos when every lane agreed
+    struct VariantReport {
+        static constexpr auto npos = std::numeric_limits<std::size_t>::max();
+
+        std::string name;
+        std::size_t elements = 0;
+        std::size_t mismatches = 0;
+        std::size_t first_mismatch = npos;
+        double elements_per_second = 0;
+    };
+
+    struct Report {
+        std::vector<VariantReport> variants;
+
+        auto passed() const -> bool {
+            return std::ranges::all_of(variants, [](VariantReport const &v) { return v.mismatches == 0; });
+        }
+
+        /// @brief {"passed": ..., "variants": [{"name": ..., ...}, ...]}, in the style of Instrumentation
+        auto to_json() const -> std::string {
+            std::string json = std::string("{\"passed\": ") + (passed() ? "true" : "false") + ", \"variants\": [";
+            for (std::size_t i = 0; i < variants.size(); ++i) {
+                auto const &v = variants[i];
+                json += (i ? ", {\"name\": \"" : "{\"name\": \"") + v.name + "\", \"elements\": " +
+                        std::to_string(v.elements) + ", \"mismatches\": " + std::to_string(v.mismatches) +
+                        ", \"first_mismatch\": " +
+                        (v.first_mismatch == VariantReport::npos ? "null" : std::to_string(v.first_mismatch)) +
+                        ", \"elements_per_second\": " + std::to_string(v.elements_per_second) + "}";
+            }
+            return json + "]}";
+        }
+    };
+
+    /* Scalar references */
+
+    template<Checkable T>
+    auto special(T lhs, T rhs) -> bool {
+        if constexpr (std::is_floating_point_v<T>) {
+            return !std::isfinite(lhs) || !std::isfinite(rhs);
+        } else {
+            return false;
+        }
+    }
+
+    namespace detail {
+
+#if defined(__SIZEOF_FLOAT128__)
+        using quad = __float128;
+#else
+        using quad = long double;
+        static_assert(std::numeric_limits<long double>::digits >= 106, "Differential needs a 106-bit float type");
+#endif
+
+        /// Type in which the sum of two T is exact whenever it is anywhere near the overflow threshold: the
+        /// smaller operand is then at least half an ulp of max, so the sum spans at most 2 * digits + 1 bits
+        template<typename T>
+        using exact_sum_t = std::conditional_t<sizeof(T) == 4, double, quad>;
+
+    }
+
+    /// @brief lhs + rhs is not representable in T, decided without NPlus: __builtin_add_overflow for integers;
+    /// for floating point, finite operands whose exact sum reaches max + ulp(max) / 2, the first magnitude
+    /// round-to-nearest takes to infinity
+    template<Checkable T>
+    auto overflows(T lhs, T rhs) -> bool {
+        if constexpr (std::is_integral_v<T>) {
+            T sum;
+            return __builtin_add_overflow(lhs, rhs, &sum);
+        } else {
+            using E = detail::exact_sum_t<T>;
+            constexpr auto max = std::numeric_limits<T>::max();
+            if (!(std::abs(lhs) <= max && std::abs(rhs) <= max)) {
+                return false;
+            }
+            auto half_ulp = static_cast<E>(max - std::nextafter(max, T{0})) / 2;
+            auto sum = static_cast<E>(lhs) + static_cast<E>(rhs);
+            return (sum < 0 ? -sum : sum) >= static_cast<E>(max) + half_ulp;
+        }
+    }
+
+    /// @brief A non-finite operand, or a sum past the top of the range
+    template<Checkable T>
+    auto upward(T lhs, T rhs) -> bool {
+        if (special(lhs, rhs)) {
+            return true;
+        }
+        if constexpr (std::is_floating_point_v<T>) {
+            return overflows(lhs, rhs) && lhs + rhs > 0;
+        } else {
+            return overflows(lhs, rhs) && rhs > 0;
+        }
+    }
+
+    /// @brief A non-finite operand, or a sum past the bottom of the range
+    template<Checkable T>
+    auto downward(T lhs, T rhs) -> bool {
+        if (special(lhs, rhs)) {
+            return true;
+        }
+        if constexpr (std::is_floating_point_v<T>) {
+            return overflows(lhs, rhs) && lhs + rhs < 0;
+        } else {
+            return overflows(lhs, rhs) && rhs < 0;
+        }
+    }
+
+    template<Checkable T>
+    auto either(T lhs, T rhs) -> bool { return special(lhs, rhs) || overflows(lhs, rhs); }
+
+    namespace detail {
+
+        template<typename T>
+        using bits_t = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+
+        /// @brief Equal including the sign of zero and the NaN payload
+        template<typename R>
+        auto same_bits(R a, R b) -> bool {
+            if constexpr (std::is_floating_point_v<R> && (sizeof(R) == 4 || sizeof(R) == 8)) {
+                return std::bit_cast<bits_t<R>>(a) == std::bit_cast<bits_t<R>>(b);
+            } else if constexpr (std::is_floating_point_v<R>) {
+                /* long double carries padding, compare by value; a NaN from Widen has no payload to keep */
+                return std::isnan(a) ? std::isnan(b) : a == b && std::signbit(a) == std::signbit(b);
+            } else {
+                return a == b;
+            }
+        }
+
+        template<Checkable T>
+        auto edge_values() -> std::vector<T> {
+            using L = std::numeric_limits<T>;
+            if constexpr (std::is_floating_point_v<T>) {
+                using B = bits_t<T>;
+                constexpr B exponent = std::bit_cast<B>(L::infinity());
+                std::vector<T> edges = {
+                        T(0), T(1), L::max(), std::nextafter(L::max(), T(0)), L::max() / 2,
+                        std::nextafter(L::max() / 2, L::infinity()), L::min(), std::nextafter(L::min(), T(0)),
+                        L::denorm_min(), L::epsilon(), L::infinity(), L::quiet_NaN(), L::signaling_NaN(),
+                        std::bit_cast<T>(static_cast<B>(exponent | 1)),
+                        std::bit_cast<T>(static_cast<B>(exponent | (exponent >> 1) | 0x5a5)),
+                };
+                auto positive = edges.size();
+                for (std::size_t i = 0; i < positive; ++i) {
+                    edges.push_back(-edges[i]);
+                }
+                return edges;
+            } else {
+                std::vector<T> edges = {T(0), T(1), L::max(), T(L::max() - 1), T(L::max() / 2), T(L::max() / 2 + 1),
+                                        L::min(), T(L::min() + 1)};
+                if constexpr (std::is_signed_v<T>) {
+                    edges.insert(edges.end(), {T(-1), T(L::min() / 2), T(L::min() / 2 - 1)});
+                }
+                return edges;
+            }
+        }
+
+        template<Checkable T>
+        auto random_value(std::mt19937_64 &rng, std::vector<T> const &edges) -> T {
+            using L = std::numeric_limits<T>;
+            auto pick = rng() % 6;
+            if constexpr (std::is_floating_point_v<T>) {
+                using B = bits_t<T>;
+                constexpr B exponent = std::bit_cast<B>(L::infinity());
+                constexpr B sign = B{1} << (sizeof(B) * 8 - 1);
+                auto word = static_cast<B>(rng());
+                switch (pick) {
+                    case 0:
+                        return edges[word % edges.size()];
+                    case 1: /* Within a few thousand ulp of ±max */
+                        return std::bit_cast<T>(static_cast<B>((std::bit_cast<B>(L::max()) - (word & 0xfff)) |
+                                                               (word & sign)));
+                    case 2: /* Subnormal */
+                        return std::bit_cast<T>(static_cast<B>(word & ~exponent));
+                    case 3: /* NaN with a random payload */
+                        return std::bit_cast<T>(static_cast<B>(word | exponent | 1));
+                    case 4:
+                        return std::bit_cast<T>(word);
+                    default:
+                        return std::uniform_real_distribution<T>(-1, 1)(rng);
+                }
+            } else {
+                auto word = static_cast<T>(rng());
+                switch (pick) {
+                    case 0:
+                        return edges[rng() % edges.size()];
+                    case 1:
+                        return static_cast<T>(L::max() - static_cast<T>(rng() % 1024));
+                    case 2:
+                        return static_cast<T>(L::min() + static_cast<T>(rng() % 1024));
+                    case 3:
+                        return static_cast<T>(word / 2);
+                    default:
+                        return word;
+                }
+            }
+        }
+
+        /// @brief rhs placed so lhs + rhs lands within a few units of ±max
+        template<Checkable T>
+        auto boundary_partner(std::mt19937_64 &rng, T lhs) -> T {
+            using L = std::numeric_limits<T>;
+            if constexpr (std::is_floating_point_v<T>) {
+                auto target = lhs < 0 ? L::lowest() : L::max();
+                auto rhs = target - lhs;
+                for (auto steps = rng() % 4; steps > 0; --steps) {
+                    rhs = std::nextafter(rhs, rng() % 2 ? L::infinity() : -L::infinity());
+                }
+                return rhs;
+            } else {
+                using U = std::make_unsigned_t<T>;
+                auto target = rng() % 2 ? L::max() : L::min();
+                auto nudge = static_cast<U>(rng() % 3) - U{1};
+                return static_cast<T>(static_cast<U>(static_cast<U>(target) - static_cast<U>(lhs)) + nudge);
+            }
+        }
+
+        template<typename F>
+        auto best_rate(std::size_t n, std::size_t repeats, F &&fn) -> double {
+            auto best = std::chrono::steady_clock::duration::max();
+            for (std::size_t r = 0; r < std::max<std::size_t>(repeats, 1); ++r) {
+                auto start = std::chrono::steady_clock::now();
+                fn();
+                best = std::min(best, std::chrono::steady_clock::now() - start);
+            }
+            auto seconds = std::chrono::duration<double>(best).count();
+            return seconds > 0 ? static_cast<double>(n) / seconds : 0;
+        }
+
+        /// @brief same_bits, except that a NaN sum may carry the (quieted) payload of either NaN operand:
+        /// IEEE 754 leaves that choice open, and compilers commute floating point additions freely. A widened
+        /// sum carries the payload as the conversion of the operand to R placed it.
+        template<typename R, typename T>
+        auto same_sum(R got, R expected, T lhs, T rhs) -> bool {
+            if (same_bits(got, expected)) {
+                return true;
+            }
+            if constexpr (std::is_floating_point_v<R> && std::is_floating_point_v<T> &&
+                          (sizeof(R) == 4 || sizeof(R) == 8)) {
+                if (std::isnan(got) && std::isnan(expected)) {
+                    constexpr auto quiet = bits_t<R>{1} << (std::numeric_limits<R>::digits - 2);
+                    auto payload = [&](T operand) {
+                        return std::isnan(operand) && (std::bit_cast<bits_t<R>>(static_cast<R>(operand)) | quiet) ==
+                                                      std::bit_cast<bits_t<R>>(got);
+                    };
+                    return payload(lhs) || payload(rhs);
+                }
+            }
+            return false;
+        }
+
+        /// @brief Count the lanes in [0, n) where matches(i) is false
+        template<typename Matches>
+        auto compare(VariantReport &report, std::size_t n, Matches &&matches) -> void {
+            report.elements = n;
+            for (std::size_t i = 0; i < n; ++i) {
+                if (!matches(i)) {
+                    report.first_mismatch = std::min(report.first_mismatch, i);
+                    ++report.mismatches;
+                }
+            }
+        }
+    }
+
+    /// @brief n operand pairs: all pairs of edge values first, then random pairs, a quarter of them placed on
+    /// the overflow boundary
+    template<Checkable T>
+    auto adversarial(std::size_t n, std::uint64_t seed = 1) -> std::pair<std::vector<T>, std::vector<T>> {
+        std::vector<T> lhs, rhs;
+        lhs.reserve(n);
+        rhs.reserve(n);
+
+        auto edges = detail::edge_values<T>();
+        for (std::size_t i = 0; i < edges.size() && lhs.size() < n; ++i) {
+            for (std::size_t j = 0; j < edges.size() && lhs.size() < n; ++j) {
+                lhs.push_back(edges[i]);
+                rhs.push_back(edges[j]);
+            }
+        }
+
+        std::mt19937_64 rng(seed);
+        while (lhs.size() < n) {
+            auto a = detail::random_value(rng, edges);
+            auto b = rng() % 4 == 0 ? detail::boundary_partner(rng, a) : detail::random_value(rng, edges);
+            if (rng() % 2) {
+                std::swap(a, b);
+            }
+            lhs.push_back(a);
+            rhs.push_back(b);
+        }
+        return {std::move(lhs), std::move(rhs)};
+    }
+
+    /// @brief Check every variant on the given operands; each is timed over repeats runs, the best counts.
+    ///
+    /// The CpuDispatch variants pin the dispatch level while they run, so nothing else should be using the
+    /// kernels concurrently; the level in effect before the call is restored afterwards.
+    template<Checkable T, OverflowPolicy Policy = default_policy<T>>
+    auto check(std::span<T const> lhs, std::span<T const> rhs, std::size_t repeats = 3) -> Report {
+        static_assert(Policy != OverflowPolicy::Throw, "Differential::check needs a policy that returns a value");
+        using R = typename NPlus<T, Policy>::result_type;
+
+        auto n = std::min(lhs.size(), rhs.size());
+        lhs = lhs.first(n);
+        rhs = rhs.first(n);
+
+        std::vector<R> expected(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            expected[i] = NPlus<T, Policy>::safe_add(lhs[i], rhs[i]);
+        }
+
+        Report report;
+        std::vector<std::uint8_t> flags(n);
+        std::vector<R> sums(n);
+
+        auto flag_variant = [&](std::string name, auto &&run, auto &&reference) {
+            VariantReport variant{std::move(name)};
+            variant.elements_per_second = detail::best_rate(n, repeats, run);
+            detail::compare(variant, n, [&](std::size_t i) { return (flags[i] != 0) == reference(lhs[i], rhs[i]); });
+            report.variants.push_back(std::move(variant));
+        };
+        auto sum_variant = [&](std::string name, auto &&run) {
+            VariantReport variant{std::move(name)};
+            variant.elements_per_second = detail::best_rate(n, repeats, run);
+            detail::compare(variant, n, [&](std::size_t i) {
+                return detail::same_sum(sums[i], expected[i], lhs[i], rhs[i]);
+            });
+            report.variants.push_back(std::move(variant));
+        };
+
+        /* CpuDispatch, once per level this CPU can run */
+        auto pinned = CpuDispatch::forced();
+        for (std::size_t l = 0; l < CpuDispatch::level_count; ++l) {
+            auto level = static_cast<CpuDispatch::IsaLevel>(l);
+            if (!CpuDispatch::supported(level)) {
+                continue;
+            }
+            CpuDispatch::force(level);
+            auto prefix = std::string("cpu_dispatch/") + CpuDispatch::isa_name(level);
+            flag_variant(prefix + "/overflow_check", [&] { CpuDispatch::overflow_check<T>(lhs, rhs, flags); },
+                         upward<T>);
+            flag_variant(prefix + "/underflow_check", [&] { CpuDispatch::underflow_check<T>(lhs, rhs, flags); },
+                         downward<T>);
+            sum_variant(prefix + "/nplus", [&] { CpuDispatch::nplus<T, Policy>(lhs, rhs, std::span<R>(sums)); });
+        }
+        CpuDispatch::restore(pinned);
+
+        /* Kernels<>, once per default policy */
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ([&] {
+                using K = Kernels<std::tuple_element_t<I, DefaultKernelPolicies>>;
+                auto prefix = "kernels/" + std::tuple_element_t<I, DefaultKernelPolicies>::name();
+                flag_variant(prefix + "/will_overflow", [&] { K::template will_overflow<T>(lhs, rhs, flags); },
+                             overflows<T>);
+                sum_variant(prefix + "/nplus", [&] { K::template nplus<T, Policy>(lhs, rhs, std::span<R>(sums)); });
+            }(), ...);
+        }(std::make_index_sequence<std::tuple_size_v<DefaultKernelPolicies>>{});
+
+        /* Pipeline: the flags of check_range and the values of add, written out by one fused run */
+        for (auto schedule: {PipelineSchedule::Fused, PipelineSchedule::Staged}) {
+            auto name = std::string("pipeline/") + (schedule == PipelineSchedule::Fused ? "fused" : "staged");
+            auto chain = pipeline<T>(lhs, rhs, {.schedule = schedule}).check_range().template add<Policy>();
+            auto run = [&] { chain.materialize(sums, flags); };
+            flag_variant(name + "/check_range", run, either<T>);
+            detail::compare(report.variants.back(), n, [&](std::size_t i) {
+                return detail::same_sum(sums[i], expected[i], lhs[i], rhs[i]);
+            });
+            report.variants.back().name += "+add";
+        }
+
+        return report;
+    }
+
+    /// @brief check() on adversarial(n, seed)
+    template<Checkable T, OverflowPolicy Policy = default_policy<T>>
+    auto run(std::size_t n = std::size_t{1} << 20, std::uint64_t seed = 1, std::size_t repeats = 3) -> Report {
+        auto [lhs, rhs] = adversarial<T>(n, seed);
+        return check<T, Policy>(std::span<T const>(lhs), std::span<T const>(rhs), repeats);
+    }
+}
+
+
+#endif
@@ -0,0 +1 @@
+#include "EpochReclamation.tcc"
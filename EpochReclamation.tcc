@@ -0,0 +1,275 @@
+#ifndef THREADED_EPOCH_RECLAMATION_TCC
+#define THREADED_EPOCH_RECLAMATION_TCC
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+/// Epoch-based memory reclamation for read-mostly shared objects.
+///
+/// Readers bracket their accesses with a Guard, which announces the global epoch in the thread's slot: one
+/// load, one store and a fence, so entering and leaving are wait-free. Writers unlink an object and retire()
+/// it; it is deleted once the global epoch has advanced twice past its retirement, at which point no guard
+/// that could have seen it is still open. The epoch only advances when every active reader has caught up, so
+/// a reader stuck inside a guard delays reclamation but never blocks other readers or writers.
+namespace Epoch {
+
+    /// Threads registered at the same time beyond this many are refused
+    inline constexpr std::size_t max_threads = 512;
+
+    /// Retirements between automatic collection attempts
+    inline constexpr std::size_t collect_interval = 64;
+
+    namespace detail {
+
+        /// @brief Announced epoch of one thread, 0 while it holds no guard
+        struct alignas(64) Slot {
+            std::atomic<std::uint64_t> epoch{0};
+            std::atomic<bool> in_use{false};
+        };
+
+        struct Retired {
+            void *object;
+            void (*destroy)(void *);
+            std::uint64_t epoch;
+        };
+
+        inline std::array<Slot, max_threads> slots{};
+        inline std::atomic<std::size_t> slots_high_water{0};
+        inline std::atomic<std::uint64_t> global_epoch{1};
+
+        inline std::mutex limbo_mutex{};
+        inline std::size_t retired_since_collect = 0;
+
+        /// @brief Objects retired and not yet freed, guarded by limbo_mutex.
+        ///
+        /// Built on first use and never destroyed: a namespace-scope vector would need a dynamic initializer to
+        /// register its destructor, and threads still retiring during exit must not see it torn down.
+        inline auto limbo() -> std::vector<Retired> & {
+            static auto &list = *new std::vector<Retired>();
+            return list;
+        }
+
+        /// @brief The calling thread's slot, claimed on first use and released when the thread exits
+        class Registration {
+            Slot *m_slot = nullptr;
+
+        public:
+            /// Open guards on this thread; only the outermost one announces an epoch
+            std::size_t depth = 0;
+
+            Registration() {
+                for (std::size_t i = 0; i < max_threads; ++i) {
+                    bool expected = false;
+                    if (slots[i].in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                        m_slot = &slots[i];
+                        auto high = slots_high_water.load(std::memory_order_relaxed);
+                        while (high < i + 1 &&
+                               !slots_high_water.compare_exchange_weak(high, i + 1, std::memory_order_acq_rel)) {
+                        }
+                        return;
+                    }
+                }
+                throw std::runtime_error("Epoch: too many threads registered");
+            }
+
+            Registration(Registration const &) = delete;
+
+            Registration &operator=(Registration const &) = delete;
+
+            ~Registration() {
+                m_slot->epoch.store(0, std::memory_order_release);
+                m_slot->in_use.store(false, std::memory_order_release);
+            }
+
+            auto slot() const noexcept -> Slot & { return *m_slot; }
+        };
+
+        inline auto registration() -> Registration & {
+            thread_local Registration registration;
+            return registration;
+        }
+
+        /// @brief Advance the global epoch if every active reader has announced the current one
+        inline auto try_advance() -> std::uint64_t {
+            /* Pairs with the fence in Guard: either a reader's load sees the unlinking exchange that came before
+               this call, or the scan below sees that reader's announced epoch (store buffering otherwise lets
+               both miss) */
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto epoch = global_epoch.load(std::memory_order_seq_cst);
+            auto used = slots_high_water.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < used; ++i) {
+                auto announced = slots[i].epoch.load(std::memory_order_seq_cst);
+                if (announced != 0 && announced != epoch) {
+                    return epoch;
+                }
+            }
+            global_epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+            return global_epoch.load(std::memory_order_seq_cst);
+        }
+    }
+
+    /// @brief Read-side critical section; pointers loaded inside it stay valid until it closes.
+    ///
+    /// Guards nest and must be destroyed on the thread that created them.
+    class Guard {
+        detail::Registration &m_registration;
+
+    public:
+        Guard() : m_registration(detail::registration()) {
+            if (m_registration.depth++ == 0) {
+                auto &slot = m_registration.slot();
+                slot.epoch.store(detail::global_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+
+        Guard(Guard const &) = delete;
+
+        Guard &operator=(Guard const &) = delete;
+
+        ~Guard() {
+            if (--m_registration.depth == 0) {
+                m_registration.slot().epoch.store(0, std::memory_order_release);
+            }
+        }
+    };
+
+    /// @brief Free every retired object whose grace period has passed; returns how many were freed
+    inline auto collect() -> std::size_t {
+        auto epoch = detail::try_advance();
+        std::vector<detail::Retired> ready;
+        {
+            std::lock_guard lock(detail::limbo_mutex);
+            auto &limbo = detail::limbo();
+            auto split = std::partition(limbo.begin(), limbo.end(),
+                                        [epoch](detail::Retired const &r) { return r.epoch + 2 > epoch; });
+            ready.assign(split, limbo.end());
+            limbo.erase(split, limbo.end());
+            detail::retired_since_collect = 0;
+        }
+        for (auto const &r: ready) {
+            r.destroy(r.object);
+        }
+        return ready.size();
+    }
+
+    /// @brief Hand an unlinked object over for deletion once no reader can still hold it
+    template<typename T>
+    auto retire(T const *object) -> void {
+        if (!object) {
+            return;
+        }
+        bool due;
+        {
+            std::lock_guard lock(detail::limbo_mutex);
+            detail::limbo().push_back({const_cast<T *>(object), [](void *p) { delete static_cast<T *>(p); },
+                                     detail::global_epoch.load(std::memory_order_seq_cst)});
+            due = ++detail::retired_since_collect >= collect_interval;
+        }
+        if (due) {
+            collect();
+        }
+    }
+
+    /// @brief Objects retired but not yet freed
+    inline auto pending() -> std::size_t {
+        std::lock_guard lock(detail::limbo_mutex);
+        return detail::limbo().size();
+    }
+
+    /// @brief Block until everything retired so far is freed. Must not be called while holding a Guard.
+    inline auto synchronize() -> void {
+        while (pending() != 0) {
+            if (collect() == 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+
+/// @brief Read-copy-update cell: wait-free snapshot reads, writers swap in a new copy and retire the old one
+template<typename T>
+class RcuCell {
+
+public: /* Public types */
+
+    /// @brief Pinned view of the value current when read() was called
+    class Snapshot {
+        Epoch::Guard m_guard{};
+        T const *m_value;
+
+    public:
+        explicit Snapshot(std::atomic<T const *> const &current)
+                : m_value(current.load(std::memory_order_acquire)) {}
+
+        Snapshot(Snapshot const &) = delete;
+
+        Snapshot &operator=(Snapshot const &) = delete;
+
+        auto get() const noexcept -> T const & { return *m_value; }
+
+        auto operator*() const noexcept -> T const & { return *m_value; }
+
+        auto operator->() const noexcept -> T const * { return m_value; }
+    };
+
+private: /* Private Members */
+
+    std::atomic<T const *> m_current;
+    std::mutex m_writer{};
+
+public: /* Constructors */
+
+    explicit RcuCell(T value = T{}) : m_current(new T(std::move(value))) {}
+
+    RcuCell(RcuCell const &) = delete;
+
+    RcuCell &operator=(RcuCell const &) = delete;
+
+    /// @brief No reader may still hold a snapshot of this cell
+    ~RcuCell() { delete m_current.load(std::memory_order_acquire); }
+
+public: /* Public Methods */
+
+    auto read() const -> Snapshot { return Snapshot(m_current); }
+
+    /// @brief Copy of the current value
+    auto load() const -> T { return *read(); }
+
+    auto store(T value) -> void {
+        auto const *fresh = new T(std::move(value));
+        T const *old;
+        {
+            std::lock_guard lock(m_writer);
+            old = m_current.exchange(fresh, std::memory_order_acq_rel);
+        }
+        Epoch::retire(old);
+    }
+
+    /// @brief Read-copy-update: fn edits a private copy of the current value, which then replaces it.
+    /// Concurrent update() calls are serialized, so none of their edits is lost.
+    template<typename F>
+    auto update(F &&fn) -> void {
+        T const *old;
+        {
+            std::lock_guard lock(m_writer);
+            auto copy = *m_current.load(std::memory_order_acquire);
+            std::forward<F>(fn)(copy);
+            old = m_current.exchange(new T(std::move(copy)), std::memory_order_acq_rel);
+        }
+        Epoch::retire(old);
+    }
+};
+
+
+#endif
@@ -0,0 +1 @@
+#include "HugePageResource.tcc"
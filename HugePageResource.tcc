@@ -0,0 +1,292 @@
+#ifndef THREADED_HUGE_PAGE_RESOURCE_TCC
+#define THREADED_HUGE_PAGE_RESOURCE_TCC
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <span>
+#include <unordered_map>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+
+enum class PageSize : std::uint8_t {
+    Default = 0,  ///< ordinary 4 KiB pages
+    Huge2M = 1,
+    Huge1G = 2,
+};
+
+
+/// @brief memory_resource for large batch buffers backed by huge pages.
+///
+/// Requests of at least `threshold` bytes are mapped directly, trying in order: an explicit MAP_HUGETLB
+/// mapping of the preferred page size (needs pages reserved in /proc/sys/vm/nr_hugepages or the 1 GiB
+/// equivalent), then an ordinary mapping aligned to 2 MiB with MADV_HUGEPAGE so transparent huge pages can
+/// back it, then the plain mapping. Each mapping is rounded to the page size it actually got, so a 1 GiB
+/// preference that falls back to transparent pages costs 2 MiB granules, not 1 GiB ones. Smaller requests go
+/// to the upstream resource. Every block is at least 64-byte aligned. stats() tells which backing the
+/// allocations actually got.
+class HugePageResource : public std::pmr::memory_resource {
+
+public: /* Public types */
+
+    struct Stats {
+        std::size_t hugetlb = 0;      ///< mappings backed by reserved huge pages
+        std::size_t transparent = 0;  ///< mappings advised for transparent huge pages
+        std::size_t plain = 0;        ///< mappings with neither
+        std::size_t upstream = 0;     ///< requests below the threshold
+        std::size_t bytes_mapped = 0; ///< currently mapped, after rounding to the page size
+    };
+
+    static constexpr std::size_t simd_alignment = 64;
+
+private: /* Private Members */
+
+    PageSize m_page;
+    std::size_t m_threshold;
+    std::pmr::memory_resource *m_upstream;
+
+    std::atomic<std::size_t> m_hugetlb{0};
+    std::atomic<std::size_t> m_transparent{0};
+    std::atomic<std::size_t> m_plain{0};
+    std::atomic<std::size_t> m_upstream_count{0};
+    std::atomic<std::size_t> m_bytes_mapped{0};
+
+    /// Length of every live mapping: which backing a request got (and so how far it was rounded) is only
+    /// known once it has been mapped
+    std::mutex m_mappings_mutex;
+    std::unordered_map<void *, std::size_t> m_mappings;
+
+private: /* Private Methods */
+
+    static constexpr auto page_bytes(PageSize page) noexcept -> std::size_t {
+        switch (page) {
+            case PageSize::Huge1G:
+                return std::size_t{1} << 30;
+            case PageSize::Huge2M:
+                return std::size_t{2} << 20;
+            default:
+                return std::size_t{4} << 10;
+        }
+    }
+
+    static constexpr auto round_up(std::size_t bytes, std::size_t page) noexcept -> std::size_t {
+        return (bytes + page - 1) / page * page;
+    }
+
+#if defined(__linux__)
+    /// @brief Map at least bytes; returns the mapping and its length, rounded to the page size it got
+    auto map(std::size_t bytes) -> std::pair<void *, std::size_t> {
+        /* No MAP_NORESERVE: without a reservation a hugetlb mapping would fault with SIGBUS on first touch */
+        constexpr int anonymous = MAP_PRIVATE | MAP_ANONYMOUS;
+
+        if (m_page != PageSize::Default) {
+            auto length = round_up(bytes, page_bytes(m_page));
+            auto size_flag = m_page == PageSize::Huge1G ? (30 << MAP_HUGE_SHIFT) : (21 << MAP_HUGE_SHIFT);
+            auto *p = mmap(nullptr, length, PROT_READ | PROT_WRITE, anonymous | MAP_HUGETLB | size_flag, -1, 0);
+            if (p != MAP_FAILED) {
+                m_hugetlb.fetch_add(1, std::memory_order_relaxed);
+                return {p, length};
+            }
+        }
+
+        if (m_page == PageSize::Default) {
+            auto length = round_up(bytes, page_bytes(PageSize::Default));
+            auto *p = mmap(nullptr, length, PROT_READ | PROT_WRITE, anonymous, -1, 0);
+            if (p == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            m_plain.fetch_add(1, std::memory_order_relaxed);
+            return {p, length};
+        }
+
+        /* Transparent huge pages are 2 MiB whatever the preferred size, so round to that. Over-map by one
+           2 MiB page and trim, so THP can use every 2 MiB of the block */
+        constexpr auto thp = page_bytes(PageSize::Huge2M);
+        auto length = round_up(bytes, thp);
+        auto over = length + thp;
+        auto *raw = mmap(nullptr, over, PROT_READ | PROT_WRITE, anonymous, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+
+        auto address = reinterpret_cast<std::uintptr_t>(raw);
+        auto aligned = (address + thp - 1) / thp * thp;
+        if (auto head = aligned - address; head != 0) {
+            munmap(raw, head);
+        }
+        if (auto tail = over - (aligned - address) - length; tail != 0) {
+            munmap(reinterpret_cast<void *>(aligned + length), tail);
+        }
+        auto *p = reinterpret_cast<void *>(aligned);
+        if (madvise(p, length, MADV_HUGEPAGE) == 0) {
+            m_transparent.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            m_plain.fetch_add(1, std::memory_order_relaxed);
+        }
+        return {p, length};
+    }
+#endif
+
+protected: /* memory_resource */
+
+    auto do_allocate(std::size_t bytes, std::size_t alignment) -> void * override {
+        alignment = std::max(alignment, simd_alignment);
+#if defined(__linux__)
+        if (bytes >= m_threshold && alignment <= page_bytes(PageSize::Default)) {
+            auto [p, length] = map(bytes);
+            try {
+                std::lock_guard lock(m_mappings_mutex);
+                m_mappings.emplace(p, length);
+            } catch (...) {
+                munmap(p, length);
+                throw;
+            }
+            m_bytes_mapped.fetch_add(length, std::memory_order_relaxed);
+            return p;
+        }
+#endif
+        m_upstream_count.fetch_add(1, std::memory_order_relaxed);
+        return m_upstream->allocate(bytes, alignment);
+    }
+
+    auto do_deallocate(void *p, std::size_t bytes, std::size_t alignment) -> void override {
+        alignment = std::max(alignment, simd_alignment);
+#if defined(__linux__)
+        if (bytes >= m_threshold && alignment <= page_bytes(PageSize::Default)) {
+            std::size_t length;
+            {
+                std::lock_guard lock(m_mappings_mutex);
+                auto node = m_mappings.extract(p);
+                length = node.mapped();
+            }
+            munmap(p, length);
+            m_bytes_mapped.fetch_sub(length, std::memory_order_relaxed);
+            return;
+        }
+#endif
+        m_upstream->deallocate(p, bytes, alignment);
+    }
+
+    auto do_is_equal(std::pmr::memory_resource const &other) const noexcept -> bool override {
+        return this == &other;
+    }
+
+public: /* Constructors */
+
+    /// @param threshold smallest request that gets its own mapping
+    explicit HugePageResource(PageSize page = PageSize::Huge2M, std::size_t threshold = std::size_t{2} << 20,
+                              std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+            : m_page(page), m_threshold(std::max<std::size_t>(threshold, 1)), m_upstream(upstream) {}
+
+    HugePageResource(HugePageResource const &) = delete;
+
+    HugePageResource &operator=(HugePageResource const &) = delete;
+
+public: /* Public Methods */
+
+    /// @brief Process-wide resource with 2 MiB pages
+    static auto shared() -> HugePageResource & {
+        static HugePageResource resource;
+        return resource;
+    }
+
+    auto page() const noexcept -> PageSize { return m_page; }
+
+    auto stats() const noexcept -> Stats {
+        return {m_hugetlb.load(std::memory_order_relaxed), m_transparent.load(std::memory_order_relaxed),
+                m_plain.load(std::memory_order_relaxed), m_upstream_count.load(std::memory_order_relaxed),
+                m_bytes_mapped.load(std::memory_order_relaxed)};
+    }
+};
+
+
+/// @brief Fixed-size array of T in memory from a HugePageResource, for buffers that never grow.
+///
+/// Unlike std::pmr::vector it never copies on growth and default-initializes, so a trivially constructible
+/// T costs nothing until the pages are first touched (and fresh mappings read as zero).
+template<typename T>
+class HugeBuffer {
+
+private: /* Private Members */
+
+    std::pmr::memory_resource *m_resource = nullptr;
+    T *m_data = nullptr;
+    std::size_t m_size = 0;
+
+public: /* Constructors */
+
+    HugeBuffer() = default;
+
+    explicit HugeBuffer(std::size_t size, std::pmr::memory_resource &resource = HugePageResource::shared())
+            : m_resource(&resource), m_size(size) {
+        if (size == 0) {
+            return;
+        }
+        auto alignment = std::max(alignof(T), HugePageResource::simd_alignment);
+        m_data = static_cast<T *>(m_resource->allocate(size * sizeof(T), alignment));
+        try {
+            std::uninitialized_default_construct_n(m_data, size);
+        } catch (...) {
+            m_resource->deallocate(m_data, size * sizeof(T), alignment);
+            throw;
+        }
+    }
+
+    HugeBuffer(HugeBuffer &&other) noexcept
+            : m_resource(other.m_resource), m_data(std::exchange(other.m_data, nullptr)),
+              m_size(std::exchange(other.m_size, 0)) {}
+
+    HugeBuffer &operator=(HugeBuffer &&other) noexcept {
+        std::swap(m_resource, other.m_resource);
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        return *this;
+    }
+
+    HugeBuffer(HugeBuffer const &) = delete;
+
+    HugeBuffer &operator=(HugeBuffer const &) = delete;
+
+    ~HugeBuffer() {
+        if (m_data) {
+            std::destroy_n(m_data, m_size);
+            m_resource->deallocate(m_data, m_size * sizeof(T), std::max(alignof(T), HugePageResource::simd_alignment));
+        }
+    }
+
+public: /* Public Methods */
+
+    auto size() const noexcept -> std::size_t { return m_size; }
+
+    auto data() noexcept -> T * { return m_data; }
+
+    auto data() const noexcept -> T const * { return m_data; }
+
+    auto operator[](std::size_t i) noexcept -> T & { return m_data[i]; }
+
+    auto operator[](std::size_t i) const noexcept -> T const & { return m_data[i]; }
+
+    auto begin() noexcept -> T * { return m_data; }
+
+    auto end() noexcept -> T * { return m_data + m_size; }
+
+    auto begin() const noexcept -> T const * { return m_data; }
+
+    auto end() const noexcept -> T const * { return m_data + m_size; }
+
+    operator std::span<T>() noexcept { return {m_data, m_size}; }
+
+    operator std::span<T const>() const noexcept { return {m_data, m_size}; }
+};
+
+
+#endif
@@ -0,0 +1 @@
+#include "Instrumentation.tcc"
@@ -0,0 +1,357 @@
+#ifndef THREADED_INSTRUMENTATION_TCC
+#define THREADED_INSTRUMENTATION_TCC
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if !defined(THREADED_INSTRUMENTATION)
+#define THREADED_INSTRUMENTATION 0
+#endif
+
+#if THREADED_INSTRUMENTATION
+#include <chrono>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#endif
+
+
+/// Hot-path counters and timers. With THREADED_INSTRUMENTATION=0 (the default) every entry point is an empty
+/// constexpr inline function and all call sites compile away; call sites whose arguments cost something to
+/// compute guard them with `if constexpr (Instrumentation::enabled)`.
+namespace Instrumentation {
+
+    enum class Counter : std::uint8_t {
+        TasksRun = 0,
+        Steals = 1,
+        Parks = 2,
+        ElementsChecked = 3,
+        OverflowsFound = 4,
+        UnderflowsFound = 5,
+        Cycles = 6,
+        LLCMisses = 7,
+        Count = 8,
+    };
+
+    enum class Timer : std::uint8_t {
+        ThreadedRun = 0,
+        OverflowCheck = 1,
+        UnderflowCheck = 2,
+        NPlusBatch = 3,
+        RadixSort = 4,
+        RadixParse = 5,
+        Count = 6,
+    };
+
+    /// True when the instrumentation is compiled in
+    inline constexpr bool enabled = THREADED_INSTRUMENTATION != 0;
+
+    inline constexpr std::size_t counter_count = static_cast<std::size_t>(Counter::Count);
+    inline constexpr std::size_t timer_count = static_cast<std::size_t>(Timer::Count);
+
+    /// @brief Totals of one timer: accumulated ticks and number of scopes
+    struct TimerTotals {
+        std::uint64_t ticks = 0;
+        std::uint64_t calls = 0;
+    };
+
+    /// @brief Point-in-time copy of the counters of one thread (or of all threads summed)
+    struct Snapshot {
+        std::array<std::uint64_t, counter_count> counters{};
+        std::array<TimerTotals, timer_count> timers{};
+    };
+
+    constexpr auto counter_name(Counter c) -> char const * {
+        constexpr std::array<char const *, counter_count> names = {
+                "tasks_run", "steals", "parks", "elements_checked", "overflows_found", "underflows_found", "cycles",
+                "llc_misses"};
+        return names[static_cast<std::size_t>(c)];
+    }
+
+    constexpr auto timer_name(Timer t) -> char const * {
+        constexpr std::array<char const *, timer_count> names = {
+                "threaded_run", "overflow_check", "underflow_check", "nplus_batch", "radix_sort", "radix_parse"};
+        return names[static_cast<std::size_t>(t)];
+    }
+
+#if THREADED_INSTRUMENTATION
+
+    /// Threads alive at once beyond this many, less one, share the last slot
+    inline constexpr std::size_t max_threads = 256;
+
+    /// @brief Counters owned by one thread at a time; padded so no two threads ever share a cache line.
+    ///
+    /// A slot outlives its thread: the counts stay and the next thread to claim it adds on top, so totals
+    /// cover exited threads too.
+    struct alignas(64) ThreadSlot {
+        std::array<std::atomic<std::uint64_t>, counter_count> counters{};
+        std::array<std::atomic<std::uint64_t>, timer_count> ticks{};
+        std::array<std::atomic<std::uint64_t>, timer_count> calls{};
+        std::atomic<bool> in_use{false};
+    };
+
+    inline std::array<ThreadSlot, max_threads> slots{};
+
+    /// One past the highest slot ever claimed
+    inline std::atomic<std::size_t> slots_claimed{0};
+
+    /// Slot written by every thread that finds the others taken, so its updates are atomic adds
+    inline ThreadSlot &shared_slot = slots[max_threads - 1];
+
+    /// @brief The calling thread's slot, claimed on first use and released when the thread exits
+    class Registration {
+        ThreadSlot *m_slot = &shared_slot;
+
+    public:
+        Registration() noexcept {
+            for (std::size_t i = 0; i + 1 < max_threads; ++i) {
+                bool expected = false;
+                if (slots[i].in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                    m_slot = &slots[i];
+                    break;
+                }
+            }
+            auto index = static_cast<std::size_t>(m_slot - slots.data());
+            auto high = slots_claimed.load(std::memory_order_relaxed);
+            while (high < index + 1 &&
+                   !slots_claimed.compare_exchange_weak(high, index + 1, std::memory_order_acq_rel)) {
+            }
+        }
+
+        Registration(Registration const &) = delete;
+
+        Registration &operator=(Registration const &) = delete;
+
+        ~Registration() {
+            if (m_slot != &shared_slot) {
+                m_slot->in_use.store(false, std::memory_order_release);
+            }
+        }
+
+        auto slot() const noexcept -> ThreadSlot & { return *m_slot; }
+    };
+
+    inline auto local_slot() -> ThreadSlot & {
+        thread_local Registration registration;
+        return registration.slot();
+    }
+
+    /// @brief Increment of a counter in the calling thread's slot: a relaxed load/store pair where the thread
+    /// is the only writer, a locked read-modify-write in the shared slot
+    inline auto bump(ThreadSlot const &slot, std::atomic<std::uint64_t> &value, std::uint64_t n) noexcept -> void {
+        if (&slot == &shared_slot) {
+            value.fetch_add(n, std::memory_order_relaxed);
+        } else {
+            value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    }
+
+    inline auto add(Counter c, std::uint64_t n = 1) noexcept -> void {
+        auto &slot = local_slot();
+        bump(slot, slot.counters[static_cast<std::size_t>(c)], n);
+    }
+
+    /// @brief Timestamp counter, or steady_clock nanoseconds where there is no TSC
+    inline auto ticks() noexcept -> std::uint64_t {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    /// @brief Adds the ticks spent in its lifetime to the given timer of the calling thread
+    class ScopedTimer {
+        Timer m_timer;
+        std::uint64_t m_start;
+
+    public:
+        explicit ScopedTimer(Timer timer) noexcept: m_timer(timer), m_start(ticks()) {}
+
+        ScopedTimer(ScopedTimer const &) = delete;
+
+        ScopedTimer &operator=(ScopedTimer const &) = delete;
+
+        ~ScopedTimer() {
+            auto &slot = local_slot();
+            auto index = static_cast<std::size_t>(m_timer);
+            bump(slot, slot.ticks[index], ticks() - m_start);
+            bump(slot, slot.calls[index], 1);
+        }
+    };
+
+    /// @brief Adds the CPU cycles and last-level cache misses of its lifetime to the calling thread's counters.
+    ///
+    /// Reads the hardware counters through perf_event_open; when they cannot be opened (not Linux, or
+    /// perf_event_paranoid forbids it) the scope records nothing.
+    class PerfScope {
+
+#if defined(__linux__)
+        struct Events {
+            int leader = -1;
+            int misses = -1;
+
+            Events() {
+                leader = open(PERF_COUNT_HW_CPU_CYCLES, -1);
+                if (leader >= 0) {
+                    misses = open(PERF_COUNT_HW_CACHE_MISSES, leader);
+                }
+            }
+
+            ~Events() {
+                if (misses >= 0) {
+                    close(misses);
+                }
+                if (leader >= 0) {
+                    close(leader);
+                }
+            }
+
+            static auto open(std::uint64_t config, int group) -> int {
+                perf_event_attr attr{};
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = config;
+                attr.disabled = group < 0;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP;
+                return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+            }
+        };
+
+        static auto events() -> Events & {
+            thread_local Events e;
+            return e;
+        }
+#endif
+
+    public:
+        PerfScope() noexcept {
+#if defined(__linux__)
+            if (auto &e = events(); e.leader >= 0) {
+                ioctl(e.leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                ioctl(e.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            }
+#endif
+        }
+
+        PerfScope(PerfScope const &) = delete;
+
+        PerfScope &operator=(PerfScope const &) = delete;
+
+        ~PerfScope() {
+#if defined(__linux__)
+            auto &e = events();
+            if (e.leader < 0) {
+                return;
+            }
+            ioctl(e.leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+            /* PERF_FORMAT_GROUP: { nr, value[nr] } */
+            std::array<std::uint64_t, 3> values{};
+            if (read(e.leader, values.data(), sizeof(values)) > 0) {
+                add(Counter::Cycles, values[1]);
+                if (values[0] > 1) {
+                    add(Counter::LLCMisses, values[2]);
+                }
+            }
+#endif
+        }
+    };
+
+    /// @brief Counters of every slot that has been claimed, in slot order; a slot sums the threads that held it
+    inline auto per_thread() -> std::vector<Snapshot> {
+        std::vector<Snapshot> result(std::min(slots_claimed.load(std::memory_order_acquire), max_threads));
+        for (std::size_t t = 0; t < result.size(); ++t) {
+            for (std::size_t c = 0; c < counter_count; ++c) {
+                result[t].counters[c] = slots[t].counters[c].load(std::memory_order_relaxed);
+            }
+            for (std::size_t i = 0; i < timer_count; ++i) {
+                result[t].timers[i] = {slots[t].ticks[i].load(std::memory_order_relaxed),
+                                       slots[t].calls[i].load(std::memory_order_relaxed)};
+            }
+        }
+        return result;
+    }
+
+#else
+
+    inline constexpr auto add(Counter, std::uint64_t = 1) noexcept -> void {}
+
+    inline constexpr auto ticks() noexcept -> std::uint64_t { return 0; }
+
+    /* The empty destructors keep scopes that are never read from tripping -Wunused-variable */
+    class ScopedTimer {
+    public:
+        constexpr explicit ScopedTimer(Timer) noexcept {}
+
+        constexpr ~ScopedTimer() {}
+    };
+
+    class PerfScope {
+    public:
+        constexpr PerfScope() noexcept = default;
+
+        constexpr ~PerfScope() {}
+    };
+
+    inline auto per_thread() -> std::vector<Snapshot> { return {}; }
+
+#endif
+
+    /// @brief Counters of all threads summed
+    inline auto snapshot() -> Snapshot {
+        Snapshot total;
+        for (auto const &thread: per_thread()) {
+            for (std::size_t c = 0; c < counter_count; ++c) {
+                total.counters[c] += thread.counters[c];
+            }
+            for (std::size_t t = 0; t < timer_count; ++t) {
+                total.timers[t].ticks += thread.timers[t].ticks;
+                total.timers[t].calls += thread.timers[t].calls;
+            }
+        }
+        return total;
+    }
+
+    /// @brief {"enabled": ..., "total": {...}, "threads": [{...}, ...]}
+    inline auto to_json() -> std::string {
+        auto object = [](Snapshot const &s) {
+            std::string json = "{\"counters\": {";
+            for (std::size_t c = 0; c < counter_count; ++c) {
+                json += (c ? ", \"" : "\"") + std::string(counter_name(static_cast<Counter>(c))) + "\": " +
+                        std::to_string(s.counters[c]);
+            }
+            json += "}, \"timers\": {";
+            for (std::size_t t = 0; t < timer_count; ++t) {
+                json += (t ? ", \"" : "\"") + std::string(timer_name(static_cast<Timer>(t))) + "\": {\"ticks\": " +
+                        std::to_string(s.timers[t].ticks) + ", \"calls\": " + std::to_string(s.timers[t].calls) + "}";
+            }
+            return json + "}}";
+        };
+
+        std::string json = std::string("{\"enabled\": ") + (enabled ? "true" : "false") +
+                           ", \"total\": " + object(snapshot()) + ", \"threads\": [";
+        auto threads = per_thread();
+        for (std::size_t t = 0; t < threads.size(); ++t) {
+            json += (t ? ", " : "") + object(threads[t]);
+        }
+        return json + "]}";
+    }
+}
+
+
+#endif
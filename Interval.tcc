@@ -0,0 +1,280 @@
+#ifndef THREADED_INTERVAL_TCC
+#define THREADED_INTERVAL_TCC
+
+#include <algorithm>
+#include <cfenv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "CpuDispatch.tcc"
+#include "NPlus.tcc"
+
+
+namespace IntervalDetail {
+
+#if defined(__x86_64__) || defined(__i386__)
+#if defined(__GNUC__) && !defined(__clang__)
+    /* GCC 12 reports the _mm512_undefined_* placeholders inside avx512fintrin.h as uninitialized */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+    /* AVX-512 embedded rounding, compiled for AVX-512 whatever the build target and only called when
+       CpuDispatch selects that level; each returns how many leading lanes it handled */
+
+    [[gnu::target("avx512f")]]
+    inline auto add_avx512(double const *lhs_lo, double const *lhs_hi, double const *rhs_lo, double const *rhs_hi,
+                           double *out_lo, double *out_hi, std::size_t n) -> std::size_t {
+        constexpr int down = _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC;
+        constexpr int up = _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC;
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm512_storeu_pd(out_lo + i, _mm512_add_round_pd(_mm512_loadu_pd(lhs_lo + i), _mm512_loadu_pd(rhs_lo + i),
+                                                             down));
+            _mm512_storeu_pd(out_hi + i, _mm512_add_round_pd(_mm512_loadu_pd(lhs_hi + i), _mm512_loadu_pd(rhs_hi + i),
+                                                             up));
+        }
+        return i;
+    }
+
+    [[gnu::target("avx512f")]]
+    inline auto add_avx512(float const *lhs_lo, float const *lhs_hi, float const *rhs_lo, float const *rhs_hi,
+                           float *out_lo, float *out_hi, std::size_t n) -> std::size_t {
+        constexpr int down = _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC;
+        constexpr int up = _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC;
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            _mm512_storeu_ps(out_lo + i, _mm512_add_round_ps(_mm512_loadu_ps(lhs_lo + i), _mm512_loadu_ps(rhs_lo + i),
+                                                             down));
+            _mm512_storeu_ps(out_hi + i, _mm512_add_round_ps(_mm512_loadu_ps(lhs_hi + i), _mm512_loadu_ps(rhs_hi + i),
+                                                             up));
+        }
+        return i;
+    }
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+}
+
+
+/// @brief Structure-of-arrays view over a batch of intervals
+template<typename N>
+struct IntervalView {
+    std::span<N> lo;
+    std::span<N> hi;
+};
+
+
+/// @brief Closed interval [lo, hi] whose arithmetic always encloses the exact result.
+///
+/// Floating point endpoints are rounded outward: lower bounds toward -inf, upper bounds toward +inf. Scalar
+/// operations get the directed roundings from the exact error term of the round-to-nearest sum, so they never
+/// touch the FPU mode. Batch kernels use AVX-512 embedded rounding when CpuDispatch runs at that level, and
+/// otherwise switch the whole pass to FE_UPWARD and compute lower bounds as -((-a) + (-b)), so both bounds
+/// come out of one pass.
+///
+/// Interval is not arithmetic, so NPlus cannot take it; overflow_check(), underflow_check() and
+/// will_overflow() are its counterparts of the addition checks, built on NPlus::will_overflow per endpoint.
+template<typename N> requires std::is_arithmetic_v<N>
+class Interval {
+
+private: /* Private Members */
+
+    N m_lo{};
+    N m_hi{};
+
+    /// Largest finite value of N
+    static constexpr auto max = std::numeric_limits<N>::max();
+
+    /// Smallest finite value of N
+    static constexpr auto lowest = std::numeric_limits<N>::lowest();
+
+private: /* Private Methods */
+
+    /// @brief RAII switch of the floating point rounding mode
+    class RoundingScope {
+        int m_previous;
+
+    public:
+        explicit RoundingScope(int mode) : m_previous(std::fegetround()) { std::fesetround(mode); }
+
+        RoundingScope(RoundingScope const &) = delete;
+
+        RoundingScope &operator=(RoundingScope const &) = delete;
+
+        ~RoundingScope() { std::fesetround(m_previous); }
+    };
+
+    /// @brief lhs + rhs rounded toward -inf (Down) or +inf (Up), assuming round-to-nearest is active
+    template<bool Up>
+    static auto add_directed(N lhs, N rhs) -> N {
+        if constexpr (std::is_integral_v<N>) {
+            /* Integer endpoints are exact; overflowed endpoints widen to the edge of the range */
+            N sum;
+            if (__builtin_add_overflow(lhs, rhs, &sum)) {
+                return Up ? max : lowest;
+            }
+            return sum;
+        } else {
+            N sum = lhs + rhs;
+            if (!std::isfinite(sum)) {
+                /* A finite overflow rounds back to the largest finite value in the inward direction */
+                if (std::isfinite(lhs) && std::isfinite(rhs)) {
+                    return Up ? (sum < 0 ? lowest : sum) : (sum > 0 ? max : sum);
+                }
+                return sum;
+            }
+
+            /* TwoSum: err is the exact rounding error, lhs + rhs == sum + err */
+            N rb = sum - lhs;
+            N err = (lhs - (sum - rb)) + (rhs - rb);
+            if constexpr (Up) {
+                return err > 0 ? std::nextafter(sum, std::numeric_limits<N>::infinity()) : sum;
+            } else {
+                return err < 0 ? std::nextafter(sum, -std::numeric_limits<N>::infinity()) : sum;
+            }
+        }
+    }
+
+    static auto finite(N n) -> bool {
+        if constexpr (std::is_integral_v<N>) {
+            return true;
+        } else {
+            return std::abs(n) <= max;
+        }
+    }
+
+public: /* Constructors */
+
+    /// @brief The degenerate interval [0, 0]
+    constexpr Interval() noexcept = default;
+
+    /// @brief The degenerate interval [point, point]
+    constexpr explicit Interval(N point) noexcept: m_lo(point), m_hi(point) {}
+
+    /// @brief The interval [lo, hi]
+    constexpr Interval(N lo, N hi) : m_lo(lo), m_hi(hi) {
+        if (!(lo <= hi)) {
+            throw std::invalid_argument("Interval lower bound must not exceed the upper bound");
+        }
+    }
+
+public: /* Public Methods */
+
+    constexpr auto lo() const noexcept -> N { return m_lo; }
+
+    constexpr auto hi() const noexcept -> N { return m_hi; }
+
+    constexpr auto width() const noexcept -> N { return m_hi - m_lo; }
+
+    constexpr auto contains(N n) const noexcept -> bool { return m_lo <= n && n <= m_hi; }
+
+    /// @brief Overflow in the positive direction: the upper endpoint sum leaves the finite range
+    /// (the AdditionOverflowCheck side of the family)
+    static auto overflow_check(Interval const &lhs, Interval const &rhs) -> bool {
+        return NPlus<N, OverflowPolicy::Wrap>::will_overflow(lhs.m_hi, rhs.m_hi) && lhs.m_hi > 0;
+    }
+
+    /// @brief Overflow in the negative direction: the lower endpoint sum leaves the finite range
+    /// (the AdditionUnderflowCheck side of the family)
+    static auto underflow_check(Interval const &lhs, Interval const &rhs) -> bool {
+        return NPlus<N, OverflowPolicy::Wrap>::will_overflow(lhs.m_lo, rhs.m_lo) && lhs.m_lo < 0;
+    }
+
+    /// @brief True if either endpoint of lhs + rhs overflows
+    static auto will_overflow(Interval const &lhs, Interval const &rhs) -> bool {
+        return NPlus<N, OverflowPolicy::Wrap>::will_overflow(lhs.m_lo, rhs.m_lo) ||
+               NPlus<N, OverflowPolicy::Wrap>::will_overflow(lhs.m_hi, rhs.m_hi);
+    }
+
+    friend auto operator+(Interval const &lhs, Interval const &rhs) -> Interval {
+        Interval result;
+        result.m_lo = add_directed<false>(lhs.m_lo, rhs.m_lo);
+        result.m_hi = add_directed<true>(lhs.m_hi, rhs.m_hi);
+        return result;
+    }
+
+    friend auto operator-(Interval const &lhs, Interval const &rhs) -> Interval {
+        return lhs + -rhs;
+    }
+
+    friend auto operator-(Interval const &i) -> Interval requires std::is_signed_v<N> {
+        Interval result;
+        result.m_lo = -i.m_hi;
+        result.m_hi = -i.m_lo;
+        return result;
+    }
+
+    auto operator+=(Interval const &rhs) -> Interval & { return *this = *this + rhs; }
+
+    auto operator-=(Interval const &rhs) -> Interval & { return *this = *this - rhs; }
+
+    friend constexpr auto operator==(Interval const &, Interval const &) noexcept -> bool = default;
+
+    /// @brief Batch enclosure of lhs + rhs over structure-of-arrays buffers
+    /// @param flags optional, set to 1 for every lane where an endpoint overflowed the finite range
+    /// @return the number of lanes where an endpoint overflowed
+    static auto add(IntervalView<N const> lhs, IntervalView<N const> rhs, IntervalView<N> out,
+                    std::span<std::uint8_t> flags = {}) -> std::size_t {
+        auto n = std::min({lhs.lo.size(), lhs.hi.size(), rhs.lo.size(), rhs.hi.size(), out.lo.size(),
+                           out.hi.size()});
+
+        if constexpr (std::is_integral_v<N>) {
+            for (std::size_t i = 0; i < n; ++i) {
+                out.lo[i] = add_directed<false>(lhs.lo[i], rhs.lo[i]);
+                out.hi[i] = add_directed<true>(lhs.hi[i], rhs.hi[i]);
+            }
+        } else {
+            std::size_t i = 0;
+#if defined(__x86_64__) || defined(__i386__)
+            if constexpr (std::is_same_v<N, double> || std::is_same_v<N, float>) {
+                if (CpuDispatch::active() == CpuDispatch::IsaLevel::Avx512) {
+                    i = IntervalDetail::add_avx512(lhs.lo.data(), lhs.hi.data(), rhs.lo.data(), rhs.hi.data(),
+                                                   out.lo.data(), out.hi.data(), n);
+                }
+            }
+#endif
+            if (i < n) {
+                /* One rounding mode for the whole pass: the lower bound is the negated upward sum of negations */
+                RoundingScope scope(FE_UPWARD);
+                for (; i < n; ++i) {
+                    out.hi[i] = lhs.hi[i] + rhs.hi[i];
+                    out.lo[i] = -((-lhs.lo[i]) + (-rhs.lo[i]));
+                }
+            }
+        }
+
+        /* A finite overflow of either endpoint leaves a non-finite (or saturated integer) bound behind */
+        std::size_t overflowed = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            bool flag;
+            if constexpr (std::is_integral_v<N>) {
+                flag = NPlus<N, OverflowPolicy::Wrap>::will_overflow(lhs.lo[i], rhs.lo[i]) ||
+                       NPlus<N, OverflowPolicy::Wrap>::will_overflow(lhs.hi[i], rhs.hi[i]);
+            } else {
+                flag = (finite(lhs.lo[i]) & finite(lhs.hi[i]) & finite(rhs.lo[i]) & finite(rhs.hi[i])) &&
+                       !(finite(out.lo[i]) & finite(out.hi[i]));
+            }
+            overflowed += flag;
+            if (!flags.empty()) {
+                flags[i] = flag;
+            }
+        }
+        return overflowed;
+    }
+};
+
+
+#endif
@@ -0,0 +1 @@
+#include "KernelPolicy.tcc"
@@ -0,0 +1,156 @@
+#ifndef THREADED_KERNEL_POLICY_TCC
+#define THREADED_KERNEL_POLICY_TCC
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <type_traits>
+
+#include "NPlus.tcc"
+#include "RadixSort.tcc"
+#include "ThreadPool.tcc"
+
+
+enum class Parallelism : std::uint8_t {
+    Sequential = 0,
+    Simd = 1,
+    Threaded = 2,
+    ThreadedSimd = 3,
+};
+
+
+/// @brief Compile-time description of how a kernel runs: whether tiles are spread over the pool, whether the
+/// tile body is the branch-free vectorizable one, the tile length, and the unroll factor of the tile body
+template<Parallelism P, std::size_t Tile = 4096, std::size_t Unroll = 4>
+struct KernelPolicy {
+
+    static_assert(Tile > 0 && Unroll > 0, "KernelPolicy needs a non-zero tile size and unroll factor");
+
+    static constexpr auto parallelism = P;
+    static constexpr std::size_t tile = Tile;
+    static constexpr std::size_t unroll = Unroll;
+    static constexpr bool threaded = P == Parallelism::Threaded || P == Parallelism::ThreadedSimd;
+    static constexpr bool simd = P == Parallelism::Simd || P == Parallelism::ThreadedSimd;
+
+    /// @brief Stable name used by the autotuner config, e.g. "threaded_simd/4096/4"
+    static auto name() -> std::string {
+        constexpr char const *names[] = {"seq", "simd", "threaded", "threaded_simd"};
+        return std::string(names[static_cast<std::size_t>(P)]) + "/" + std::to_string(Tile) + "/" +
+               std::to_string(Unroll);
+    }
+};
+
+
+/* Concept for a kernel policy */
+template<typename T>
+concept KernelPolicyQ = requires {
+    { T::parallelism } -> std::convertible_to<Parallelism>;
+    { T::tile } -> std::convertible_to<std::size_t>;
+    { T::unroll } -> std::convertible_to<std::size_t>;
+    { T::threaded } -> std::convertible_to<bool>;
+    { T::simd } -> std::convertible_to<bool>;
+};
+
+
+/// @brief The will_overflow, NPlus, and radix sort kernels instantiated for one policy.
+///
+/// Every decision the policy encodes is taken with if constexpr, so an instantiation contains only the loop
+/// it asked for; choosing between instantiations (see Autotuner) happens once per call, outside the kernel.
+template<KernelPolicyQ Policy>
+class Kernels {
+
+private: /* Private Methods */
+
+    /// @brief Run body(begin, end) over [0, n) in tiles, on the pool when the policy is threaded
+    template<typename Body>
+    static auto for_tiles(std::size_t n, Body &&body) -> std::size_t {
+        auto tiles = (n + Policy::tile - 1) / Policy::tile;
+        if constexpr (Policy::threaded) {
+            std::atomic<std::size_t> total{0};
+            ThreadPool::shared().for_each_index(tiles, [&](std::size_t t) {
+                auto begin = t * Policy::tile;
+                total.fetch_add(body(begin, std::min(n, begin + Policy::tile)), std::memory_order_relaxed);
+            });
+            return total.load(std::memory_order_relaxed);
+        } else {
+            std::size_t total = 0;
+            for (std::size_t t = 0; t < tiles; ++t) {
+                auto begin = t * Policy::tile;
+                total += body(begin, std::min(n, begin + Policy::tile));
+            }
+            return total;
+        }
+    }
+
+public: /* Public Methods */
+
+    /// @brief flags[i] = NPlus::will_overflow(lhs[i], rhs[i]): the sum leaves the range in either direction, and
+    /// non-finite operands are never flagged (unlike CpuDispatch::overflow_check)
+    /// @return the number of overflowing lanes
+    template<typename T>
+    static auto will_overflow(std::span<T const> lhs, std::span<T const> rhs, std::span<std::uint8_t> flags)
+    -> std::size_t {
+        using Add = NPlus<T, OverflowPolicy::Wrap>;
+        auto n = std::min({lhs.size(), rhs.size(), flags.size()});
+
+        return for_tiles(n, [&](std::size_t begin, std::size_t end) -> std::size_t {
+            std::size_t count = 0;
+            std::size_t i = begin;
+            if constexpr (Policy::simd) {
+                for (; i + Policy::unroll <= end; i += Policy::unroll) {
+                    for (std::size_t u = 0; u < Policy::unroll; ++u) {
+                        auto sum = Add::wrapping_add(lhs[i + u], rhs[i + u]);
+                        auto flag = Add::overflowed(lhs[i + u], rhs[i + u], sum);
+                        flags[i + u] = flag;
+                        count += flag;
+                    }
+                }
+            }
+            for (; i < end; ++i) {
+                flags[i] = Add::will_overflow(lhs[i], rhs[i]);
+                count += flags[i];
+            }
+            return count;
+        });
+    }
+
+    /// @brief NPlus<T, Overflow> element-wise addition into out
+    /// @return the number of lanes where lhs[i] + rhs[i] overflows (NPlus::will_overflow), whatever the policy
+    template<typename T, OverflowPolicy Overflow>
+    static auto nplus(std::span<T const> lhs, std::span<T const> rhs,
+                      std::span<typename NPlus<T, Overflow>::result_type> out) -> std::size_t {
+        using Add = NPlus<T, Overflow>;
+        auto n = std::min({lhs.size(), rhs.size(), out.size()});
+
+        return for_tiles(n, [&](std::size_t begin, std::size_t end) -> std::size_t {
+            std::size_t count = 0;
+            if constexpr (Policy::simd) {
+                /* The batch operator counts its slow-path lanes, which for NaN include special operands */
+                auto len = end - begin;
+                Add{}(lhs.subspan(begin, len), rhs.subspan(begin, len), out.subspan(begin, len));
+                for (auto i = begin; i < end; ++i) {
+                    count += Add::overflowed(lhs[i], rhs[i], Add::wrapping_add(lhs[i], rhs[i]));
+                }
+            } else {
+                for (auto i = begin; i < end; ++i) {
+                    count += Add::will_overflow(lhs[i], rhs[i]);
+                    out[i] = Add::safe_add(lhs[i], rhs[i]);
+                }
+            }
+            return count;
+        });
+    }
+
+    /// @brief LSD radix sort, on one thread unless the policy is threaded
+    template<RadixSortableKey Key>
+    static auto radix_sort(std::span<Key> keys) -> void {
+        RadixSort<Key>{}(keys, Policy::threaded ? ThreadPool::shared().concurrency() : 1);
+    }
+};
+
+
+#endif
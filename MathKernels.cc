@@ -0,0 +1 @@
+#include "MathKernels.tcc"
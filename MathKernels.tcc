@@ -0,0 +1,336 @@
+#ifndef THREADED_MATH_KERNELS_TCC
+#define THREADED_MATH_KERNELS_TCC
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "NegativeInfinityQ.tcc"
+#include "PositiveInfinityQ.tcc"
+
+
+/// Per-lane result flags of the MathKernels batch functions (bit set)
+enum class MathFlag : std::uint8_t {
+    None = 0,
+    Overflow = 1,   ///< finite operands, infinite result
+    Underflow = 2,  ///< finite operands, exact result non-zero but flushed to zero
+    Domain = 4,     ///< finite operands, NaN result
+};
+
+enum class PolyScheme : std::uint8_t {
+    Horner = 0,
+    Estrin = 1,
+};
+
+
+/// @brief Batch polynomial, exp, log and pow evaluation over spans.
+///
+/// Lanes are processed in blocks: each block is computed by branch-free loops that vectorize across lanes,
+/// then the same block (still in L1) is checked for non-finite results from finite operands. Only blocks with
+/// such a lane take the classification path, which sorts each one into overflow (via PositiveInfinityQ and
+/// NegativeInfinityQ) or domain error, so the overflow check costs no second pass over memory.
+///
+/// Accuracy (double): exp and log within 1 ulp (Cody-Waite reduction, fdlibm polynomials); pow is
+/// exp(y log x) with the product corrected by its rounding error, about (1 + |y log x|) ulp. float lanes are
+/// computed in double and rounded once, so they are within 1 ulp throughout.
+template<std::floating_point T> requires (std::numeric_limits<T>::digits <= 53)
+class MathKernels {
+
+private: /* Private Members */
+
+    static constexpr std::size_t block = 256;
+
+    /* Working precision: the reductions below operate on IEEE binary64 bit patterns */
+    using W = double;
+
+    static constexpr W ln2_hi = 6.93147180369123816490e-01;
+    static constexpr W ln2_lo = 1.90821492927058770002e-10;
+    static constexpr W inv_ln2 = 1.44269504088896338700e+00;
+
+    /// exp(x) overflows above this and underflows to zero below exp_min
+    static constexpr W exp_max = 709.782712893383973096;
+    static constexpr W exp_min = -745.133219101941108420;
+
+private: /* Private Methods */
+
+    static constexpr auto finite(T n) -> bool { return std::abs(n) <= std::numeric_limits<T>::max(); }
+
+    /// @brief 2^k for integral-valued k in [-1075, 1024], as two in-range factors applied to p
+    static auto scale(W p, W k) -> W {
+        auto k1 = static_cast<std::int64_t>(k) / 2;
+        auto k2 = static_cast<std::int64_t>(k) - k1;
+        auto f1 = std::bit_cast<double>(static_cast<std::uint64_t>(k1 + 1023) << 52);
+        auto f2 = std::bit_cast<double>(static_cast<std::uint64_t>(k2 + 1023) << 52);
+        return p * f1 * f2;
+    }
+
+    /// @brief Branch-free exp in working precision
+    static auto exp_lane(W x) -> W {
+        auto xc = std::clamp(x, exp_min - 1, exp_max + 1);
+
+        /* k = round(x / ln2) by the shifter trick; r = x - k ln2 with ln2 split so k * ln2_hi is exact */
+        constexpr W shifter = 0x1.8p52;
+        auto k = (xc * inv_ln2 + shifter) - shifter;
+        auto r = (xc - k * ln2_hi) - k * ln2_lo;
+
+        /* e^r on |r| <= ln2 / 2, Taylor to degree 13 */
+        W p = 1.0 / 6227020800.0;
+        constexpr std::array<W, 13> c = {
+                1.0 / 479001600.0, 1.0 / 39916800.0, 1.0 / 3628800.0, 1.0 / 362880.0, 1.0 / 40320.0,
+                1.0 / 5040.0, 1.0 / 720.0, 1.0 / 120.0, 1.0 / 24.0, 1.0 / 6.0, 0.5, 1.0, 1.0};
+        for (auto ci: c) {
+            p = p * r + ci;
+        }
+
+        auto result = scale(p, k);
+        return x != x ? x : result;
+    }
+
+    /// @brief Branch-free natural log in working precision (fdlibm e_log reduction and polynomial)
+    static auto log_lane(W x) -> W {
+        constexpr W Lg1 = 6.666666666666735130e-01, Lg2 = 3.999999999940941908e-01;
+        constexpr W Lg3 = 2.857142874366239149e-01, Lg4 = 2.222219843214978396e-01;
+        constexpr W Lg5 = 1.818357216161805012e-01, Lg6 = 1.531383769920937332e-01;
+        constexpr W Lg7 = 1.479819860511658591e-01;
+
+        /* Subnormals are scaled into the normal range first */
+        bool subnormal = x < std::numeric_limits<double>::min();
+        auto xs = subnormal ? x * 0x1p54 : x;
+        auto bits = std::bit_cast<std::uint64_t>(xs);
+        auto e = static_cast<std::int64_t>((bits >> 52) & 0x7ff) - 1023 - (subnormal ? 54 : 0);
+
+        /* m in [sqrt(2)/2, sqrt(2)) */
+        auto mbits = (bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL;
+        bool high = mbits > 0x3ff6a09e667f3bcdULL;
+        mbits = high ? mbits - 0x0010000000000000ULL : mbits;
+        e += high;
+        auto m = std::bit_cast<double>(mbits);
+
+        auto f = m - 1.0;
+        auto s = f / (2.0 + f);
+        auto z = s * s;
+        auto w = z * z;
+        auto t1 = w * (Lg2 + w * (Lg4 + w * Lg6));
+        auto t2 = z * (Lg1 + w * (Lg3 + w * (Lg5 + w * Lg7)));
+        auto R = t2 + t1;
+        auto hfsq = 0.5 * f * f;
+        auto k = static_cast<W>(e);
+        auto result = k * ln2_hi - ((hfsq - (s * (hfsq + R) + k * ln2_lo)) - f);
+
+        /* log(+inf) = +inf, log(0) = -inf, log(x < 0) = NaN, log(NaN) = NaN */
+        result = x == std::numeric_limits<W>::infinity() ? x : result;
+        result = x == 0 ? -std::numeric_limits<W>::infinity() : result;
+        result = x < 0 ? std::numeric_limits<W>::quiet_NaN() : result;
+        return x != x ? x : result;
+    }
+
+    static auto pow_lane(W x, W y) -> W {
+        auto ax = std::abs(x);
+        auto l = log_lane(ax);
+        W result;
+        if constexpr (std::is_same_v<T, float>) {
+            result = exp_lane(y * l);
+        } else {
+            /* exp(t + err) ~ exp(t) (1 + err), err being the rounding error of the product */
+            auto t = y * l;
+            auto err = std::fma(y, l, -t);
+            result = exp_lane(t);
+            result = std::abs(t) < exp_max ? result + result * err : result;
+        }
+
+        /* Infinite y is neither integral nor odd; every finite W of magnitude 2^53 or more is even */
+        constexpr auto inf = std::numeric_limits<W>::infinity();
+        bool finite_y = std::abs(y) < inf;
+        bool integral = finite_y && std::trunc(y) == y;
+        bool odd = integral && std::abs(y) < W{0x1p53} && std::fmod(y, W{2}) != 0;
+        result = x < 0 && odd ? -result : result;
+        result = x < 0 && ax < inf && finite_y && !integral ? std::numeric_limits<W>::quiet_NaN() : result;
+        result = x == 0 && y == y ? (y < 0 ? (odd ? std::copysign(inf, x) : inf) : (odd ? x : W{0})) : result;
+        result = x == 1 || y == 0 || (ax == 1 && !finite_y && y == y) ? W{1} : result;
+        return result;
+    }
+
+    /// @brief Flag lanes [base, base + len) of out whose operands were finite; returns the flagged count.
+    ///
+    /// ok(i) says whether lane i had finite operands, zero(i) whether an exact zero result is legitimate.
+    template<typename Finite, typename Zero>
+    static auto classify(std::span<T> out, std::size_t base, std::size_t len, std::span<std::uint8_t> flags,
+                         Finite &&ok, Zero &&zero_ok) -> std::size_t {
+        bool any = false;
+        for (std::size_t i = 0; i < len; ++i) {
+            auto v = out[base + i];
+            bool special = !finite(v) || (v == 0 && !zero_ok(base + i));
+            any |= ok(base + i) && special;
+        }
+        if (!any) {
+            if (!flags.empty()) {
+                std::fill_n(flags.begin() + static_cast<std::ptrdiff_t>(base), len, std::uint8_t{0});
+            }
+            return 0;
+        }
+
+        std::size_t flagged = 0;
+        for (std::size_t i = 0; i < len; ++i) {
+            auto v = out[base + i];
+            auto flag = MathFlag::None;
+            if (ok(base + i)) {
+                if (Predicates::PositiveInfinityQ<T>{}(v) || Predicates::NegativeInfinityQ<T>{}(v)) {
+                    flag = MathFlag::Overflow;
+                } else if (v != v) {
+                    flag = MathFlag::Domain;
+                } else if (v == 0 && !zero_ok(base + i)) {
+                    flag = MathFlag::Underflow;
+                }
+            }
+            flagged += flag != MathFlag::None;
+            if (!flags.empty()) {
+                flags[base + i] = static_cast<std::uint8_t>(flag);
+            }
+        }
+        return flagged;
+    }
+
+public: /* Public Methods */
+
+    /// @brief out[i] = sum_k coeffs[k] x[i]^k
+    /// @param flags optional, receives a MathFlag per lane
+    /// @return the number of flagged lanes
+    template<PolyScheme Scheme = PolyScheme::Estrin>
+    static auto polynomial(std::span<T const> coeffs, std::span<T const> x, std::span<T> out,
+                           std::span<std::uint8_t> flags = {}) -> std::size_t {
+        auto n = std::min(x.size(), out.size());
+        if (!flags.empty()) {
+            n = std::min(n, flags.size());
+        }
+        bool coeffs_finite = std::all_of(coeffs.begin(), coeffs.end(), [](T c) { return finite(c); });
+        std::size_t flagged = 0;
+
+        std::vector<T> scratch;
+        if constexpr (Scheme == PolyScheme::Estrin) {
+            scratch.resize(block * ((coeffs.size() + 1) / 2));
+        }
+
+        for (std::size_t base = 0; base < n; base += block) {
+            auto len = std::min(block, n - base);
+            auto *xs = x.data() + base;
+            auto *ys = out.data() + base;
+
+            if (coeffs.empty()) {
+                std::fill_n(ys, len, T{0});
+            } else if constexpr (Scheme == PolyScheme::Horner) {
+                std::fill_n(ys, len, coeffs.back());
+                for (auto k = coeffs.size() - 1; k-- > 0;) {
+                    for (std::size_t i = 0; i < len; ++i) {
+                        ys[i] = ys[i] * xs[i] + coeffs[k];
+                    }
+                }
+            } else {
+                /* Level 0: pairs c[2j] + c[2j+1] x; each further level pairs neighbours with the next power */
+                auto terms = (coeffs.size() + 1) / 2;
+                for (std::size_t j = 0; j < terms; ++j) {
+                    auto *p = scratch.data() + j * block;
+                    auto c0 = coeffs[2 * j];
+                    auto c1 = 2 * j + 1 < coeffs.size() ? coeffs[2 * j + 1] : T{0};
+                    for (std::size_t i = 0; i < len; ++i) {
+                        p[i] = c0 + c1 * xs[i];
+                    }
+                }
+                std::array<T, block> power;
+                for (std::size_t i = 0; i < len; ++i) {
+                    power[i] = xs[i] * xs[i];
+                }
+                for (; terms > 1; terms = (terms + 1) / 2) {
+                    for (std::size_t j = 0; j < terms / 2; ++j) {
+                        auto *lo = scratch.data() + 2 * j * block;
+                        auto *hi = lo + block;
+                        auto *dst = scratch.data() + j * block;
+                        for (std::size_t i = 0; i < len; ++i) {
+                            dst[i] = lo[i] + hi[i] * power[i];
+                        }
+                    }
+                    if (terms % 2) {
+                        std::copy_n(scratch.data() + (terms - 1) * block, len, scratch.data() + (terms / 2) * block);
+                    }
+                    for (std::size_t i = 0; i < len; ++i) {
+                        power[i] = power[i] * power[i];
+                    }
+                }
+                std::copy_n(scratch.data(), len, ys);
+            }
+
+            flagged += classify(out, base, len, flags,
+                                [&](std::size_t i) { return coeffs_finite && finite(x[i]); },
+                                [](std::size_t) { return true; });
+        }
+        return flagged;
+    }
+
+    /// @brief out[i] = e^x[i]
+    static auto exp(std::span<T const> x, std::span<T> out, std::span<std::uint8_t> flags = {}) -> std::size_t {
+        auto n = std::min(x.size(), out.size());
+        if (!flags.empty()) {
+            n = std::min(n, flags.size());
+        }
+        std::size_t flagged = 0;
+        for (std::size_t base = 0; base < n; base += block) {
+            auto len = std::min(block, n - base);
+            for (std::size_t i = base; i < base + len; ++i) {
+                out[i] = static_cast<T>(exp_lane(static_cast<W>(x[i])));
+            }
+            flagged += classify(out, base, len, flags,
+                                [&](std::size_t i) { return finite(x[i]); },
+                                [](std::size_t) { return false; });
+        }
+        return flagged;
+    }
+
+    /// @brief out[i] = ln x[i]; zero maps to -inf (flagged Overflow), negatives to NaN (flagged Domain)
+    static auto log(std::span<T const> x, std::span<T> out, std::span<std::uint8_t> flags = {}) -> std::size_t {
+        auto n = std::min(x.size(), out.size());
+        if (!flags.empty()) {
+            n = std::min(n, flags.size());
+        }
+        std::size_t flagged = 0;
+        for (std::size_t base = 0; base < n; base += block) {
+            auto len = std::min(block, n - base);
+            for (std::size_t i = base; i < base + len; ++i) {
+                out[i] = static_cast<T>(log_lane(static_cast<W>(x[i])));
+            }
+            flagged += classify(out, base, len, flags,
+                                [&](std::size_t i) { return finite(x[i]); },
+                                [](std::size_t) { return true; });
+        }
+        return flagged;
+    }
+
+    /// @brief out[i] = x[i]^y[i] with the C pow conventions for zeros, infinities and negative bases
+    static auto pow(std::span<T const> x, std::span<T const> y, std::span<T> out, std::span<std::uint8_t> flags = {})
+    -> std::size_t {
+        auto n = std::min({x.size(), y.size(), out.size()});
+        if (!flags.empty()) {
+            n = std::min(n, flags.size());
+        }
+        std::size_t flagged = 0;
+        for (std::size_t base = 0; base < n; base += block) {
+            auto len = std::min(block, n - base);
+            for (std::size_t i = base; i < base + len; ++i) {
+                out[i] = static_cast<T>(pow_lane(static_cast<W>(x[i]), static_cast<W>(y[i])));
+            }
+            flagged += classify(out, base, len, flags,
+                                [&](std::size_t i) { return finite(x[i]) && finite(y[i]); },
+                                [&](std::size_t i) { return x[i] == 0; });
+        }
+        return flagged;
+    }
+};
+
+
+#endif
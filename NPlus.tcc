@@ -26,11 +26,65 @@
 #include <map>
 #include <set>
 #include <variant>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+#include "Instrumentation.tcc"
+
+enum class OverflowPolicy : std::uint8_t {
+    Saturate = 0,
+    Wrap = 1,
+    NaN = 2,    ///< the original safe_add: infinite or NaN operands give NaN, a finite overflow gives the IEEE infinity
+    Throw = 3,
+    Widen = 4,
+};
+
+
+/// Policy NPlus<T> uses when none is given: the original NaN handling for floating point, which integers
+/// cannot have, so they saturate
+template<typename T>
+inline constexpr auto default_overflow_policy = std::is_floating_point_v<T> ? OverflowPolicy::NaN
+                                                                            : OverflowPolicy::Saturate;
+
+
+/* Next-wider type used by OverflowPolicy::Widen */
+template<typename T>
+struct Widened {
+    using type = T;
+};
+
+template<> struct Widened<std::int8_t> { using type = std::int16_t; };
+template<> struct Widened<std::int16_t> { using type = std::int32_t; };
+template<> struct Widened<std::int32_t> { using type = std::int64_t; };
+template<> struct Widened<std::int64_t> { using type = __int128; };
+template<> struct Widened<std::uint8_t> { using type = std::uint16_t; };
+template<> struct Widened<std::uint16_t> { using type = std::uint32_t; };
+template<> struct Widened<std::uint32_t> { using type = std::uint64_t; };
+template<> struct Widened<std::uint64_t> { using type = unsigned __int128; };
+template<> struct Widened<float> { using type = double; };
+template<> struct Widened<double> { using type = long double; };
 
-/* Template: typename T, template <typename> class Container, template <typename> class Allocator, std::size_t N = null */
 template<typename T>
+using widened_t = typename Widened<T>::type;
+
+
+/* Template: typename T, OverflowPolicy Policy = NaN for floating point (the original safe_add behaviour) */
+template<typename T, OverflowPolicy Policy = default_overflow_policy<T>> requires std::is_arithmetic_v<T>
 class NPlus {
 
+    static_assert(Policy != OverflowPolicy::NaN || std::is_floating_point_v<T>,
+                  "OverflowPolicy::NaN needs a floating point type, integers have no NaN");
+    static_assert(Policy != OverflowPolicy::Widen || !std::is_same_v<widened_t<T>, T>,
+                  "OverflowPolicy::Widen needs a type with a wider counterpart");
+
+public: /* Public types */
+
+    /// Element type of results: T, or the next-wider type in Widen mode
+    using result_type = std::conditional_t<Policy == OverflowPolicy::Widen, widened_t<T>, T>;
+
 private: /* Private types */
 
     template<
@@ -46,12 +100,12 @@ private: /* Private types */
 
 
 private: /* Private variables */
-    static constinit auto pos_inf = std::numeric_limits<T>::infinity();
-    static constinit auto neg_inf = std::minus<T>()(std::numeric_limits<T>::infinity());
-    static constinit auto nan = std::numeric_limits<T>::quiet_NaN();
-    static constinit auto pos_inf_ptr = std::make_optional(pos_inf);
-    static constinit auto neg_inf_ptr = std::make_optional(neg_inf);
-    static constinit auto nan_ptr = std::make_optional(nan);
+    static constexpr auto pos_inf = std::numeric_limits<T>::infinity();
+    static constexpr auto neg_inf = -std::numeric_limits<T>::infinity();
+    static constexpr auto nan = std::numeric_limits<T>::quiet_NaN();
+
+    /// Lanes per block of the batch kernel; flags for one block stay in L1
+    static constexpr std::size_t block = 256;
 
 
 public: /* Constructors */
@@ -59,72 +113,148 @@ public: /* Constructors */
 
 private: /* Private methods */
 
-    static auto will_overflow(T lhs, T rhs) -> bool;
-    auto safe_add(T lhs, T rhs) -> T;
+    /// @brief Result for a lane whose sum does not fit in T, as dictated by Policy
+    static auto on_overflow(T lhs, T rhs) -> result_type {
+        if constexpr (Policy == OverflowPolicy::Saturate) {
+            if constexpr (std::is_integral_v<T>) {
+                return lhs > 0 ? std::numeric_limits<T>::max() : std::numeric_limits<T>::min();
+            } else {
+                return lhs + rhs > 0 ? std::numeric_limits<T>::max() : std::numeric_limits<T>::lowest();
+            }
+        } else if constexpr (Policy == OverflowPolicy::Wrap) {
+            if constexpr (std::is_integral_v<T>) {
+                using U = std::make_unsigned_t<T>;
+                return static_cast<T>(static_cast<U>(static_cast<U>(lhs) + static_cast<U>(rhs)));
+            } else {
+                return lhs + rhs;
+            }
+        } else if constexpr (Policy == OverflowPolicy::NaN) {
+            /* Only finite operands get here; like the original safe_add, they keep the IEEE sum */
+            return lhs + rhs;
+        } else if constexpr (Policy == OverflowPolicy::Throw) {
+            throw std::overflow_error("NPlus: addition overflow");
+        } else {
+            return static_cast<result_type>(lhs) + static_cast<result_type>(rhs);
+        }
+    }
+
+    /// @brief Vectorizable sum of one lane plus a flag telling whether it needs safe_add
+    static auto fast_lane(T lhs, T rhs, T &sum) -> bool {
+        sum = wrapping_add(lhs, rhs);
+        if constexpr (Policy == OverflowPolicy::NaN) {
+            /* Every non-finite result goes through safe_add, which tells special operands from finite overflow */
+            return !(std::abs(sum) <= std::numeric_limits<T>::max());
+        } else {
+            return overflowed(lhs, rhs, sum);
+        }
+    }
 
 
 public: /* Public methods */
 
-    template<
-            template<typename, typename> class Container,
-            template<typename> class Allocator = std::allocator,
-            std::size_t N = 0>
-    static constexpr Container<T, Allocator<T>> &operator()(
-            std::add_const<std::add_rvalue_reference<Container<T, Allocator<T>>>> LHS,
-            std::add_const<std::add_rvalue_reference<Container<T, Allocator<T>>>> RHS) {
-        return std::transform(std::execution::par, LHS.begin(), LHS.end(), RHS.begin(), LHS.begin(), std::plus<T>());
+    /// @brief lhs + rhs modulo 2^bits for integers, the IEEE sum for floating point
+    static constexpr auto wrapping_add(T lhs, T rhs) noexcept -> T {
+        if constexpr (std::is_integral_v<T>) {
+            using U = std::make_unsigned_t<T>;
+            return static_cast<T>(static_cast<U>(static_cast<U>(lhs) + static_cast<U>(rhs)));
+        } else {
+            return lhs + rhs;
+        }
     }
-};
-
-template<typename T>
-auto NPlus<T>::will_overflow(T lhs, T rhs) -> bool {
 
-
-    /* Check for overflow */
-    if (lhs > 0 && rhs > 0 && lhs > pos_inf - rhs) {
-        // if lhs + rhs > +inf, then lhs + rhs will overflow
-        // or       rhs > +inf - lhs, then lhs + rhs will overflow
-        return rhs > NPlus<T>::pos_inf_ptr.value() - lhs;
+    /// @brief Branch-free overflow test for sum == wrapping_add(lhs, rhs), suitable for vectorized loops
+    static constexpr auto overflowed(T lhs, T rhs, T sum) noexcept -> bool {
+        if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            return ((lhs ^ sum) & (rhs ^ sum)) < 0;
+        } else if constexpr (std::is_integral_v<T>) {
+            return sum < lhs;
+        } else {
+            constexpr auto max = std::numeric_limits<T>::max();
+            return (std::abs(lhs) <= max) & (std::abs(rhs) <= max) & !(std::abs(sum) <= max);
+        }
     }
 
-    /* Check if a + b would underflow */
-    if (lhs < 0 && rhs < 0 && lhs < neg_inf - rhs) {
-        // if lhs + rhs < -inf, then lhs + rhs will overflow
-        // or       rhs < -inf - lhs, then lhs + rhs will overflow
-        return rhs < NPlus<T>::neg_inf_ptr.value() - lhs;
+    /// @brief True if lhs + rhs is not representable in T (finite operands with a non-finite sum for floats)
+    static auto will_overflow(T lhs, T rhs) -> bool {
+        if constexpr (std::is_integral_v<T>) {
+            T sum;
+            return __builtin_add_overflow(lhs, rhs, &sum);
+        } else {
+            return std::isfinite(lhs) && std::isfinite(rhs) && !std::isfinite(lhs + rhs);
+        }
     }
 
-    if (lhs < 0 && rhs > 0 && lhs < neg_inf + rhs) {
-        // if lhs + rhs < -inf, then lhs + rhs will overflow
-        // or       rhs > -inf + lhs, then lhs + rhs will overflow
-        return rhs > NPlus<T>::neg_inf_ptr.value() + lhs;
+    /// @brief Checked scalar addition; overflow is resolved according to Policy
+    static auto safe_add(T lhs, T rhs) -> result_type {
+        if constexpr (Policy == OverflowPolicy::NaN) {
+            if (std::isinf(lhs) && std::isinf(rhs)) {
+                if (lhs == rhs) {
+                    return lhs;
+                } else {
+                    return nan;
+                }
+            } else if (std::isinf(lhs) || std::isinf(rhs)) {
+                return nan;
+            } else if (std::isnan(lhs) || std::isnan(rhs)) {
+                return nan;
+            }
+        }
+
+        if (will_overflow(lhs, rhs)) {
+            return on_overflow(lhs, rhs);
+        }
+        return static_cast<result_type>(lhs + rhs);
     }
 
-    if (lhs > 0 && rhs < 0 && lhs > pos_inf + rhs) {
-        // if lhs + rhs > +inf, then lhs + rhs will overflow
-        // or       rhs < +inf + lhs, then lhs + rhs will overflow
-        return rhs < NPlus<T>::pos_inf_ptr.value() + lhs;
+    static auto operator()(T lhs, T rhs) -> result_type {
+        return safe_add(lhs, rhs);
     }
 
-    return false;
-}
+    /// @brief Element-wise checked addition into out.
+    ///
+    /// Every block of lanes is summed on the fast path first; only the lanes flagged there are recomputed
+    /// through safe_add (in the wider type for Widen), the rest of the block is left untouched.
+    /// @return the number of lanes that took the slow path
+    static auto operator()(std::span<T const> lhs, std::span<T const> rhs, std::span<result_type> out)
+    -> std::size_t {
+        Instrumentation::ScopedTimer timer(Instrumentation::Timer::NPlusBatch);
 
-template<typename T>
-auto NPlus<T>::safe_add(T lhs, T rhs) -> T {
-    if (std::isinf(lhs) && std::isinf(rhs)) {
-        if (lhs == rhs) {
-            return lhs;
-        } else {
-            return nan;
+        auto n = std::min({lhs.size(), rhs.size(), out.size()});
+        std::size_t flagged = 0;
+
+        for (std::size_t base = 0; base < n; base += block) {
+            auto len = std::min(block, n - base);
+            std::array<std::uint8_t, block> flag{};
+            std::uint8_t any = 0;
+
+            for (std::size_t i = 0; i < len; ++i) {
+                T sum;
+                flag[i] = fast_lane(lhs[base + i], rhs[base + i], sum);
+                out[base + i] = static_cast<result_type>(sum);
+                any |= flag[i];
+            }
+
+            if (any) {
+                for (std::size_t i = 0; i < len; ++i) {
+                    if (flag[i]) {
+                        out[base + i] = safe_add(lhs[base + i], rhs[base + i]);
+                        ++flagged;
+                    }
+                }
+            }
         }
-    } else if (std::isinf(lhs) || std::isinf(rhs)) {
-        return nan;
-    } else if (std::isnan(lhs) || std::isnan(rhs)) {
-        return nan;
-    } else {
-        return lhs + rhs;
+
+        Instrumentation::add(Instrumentation::Counter::ElementsChecked, n);
+        Instrumentation::add(Instrumentation::Counter::OverflowsFound, flagged);
+        return flagged;
     }
-}
+
+    static auto operator()(std::vector<T> const &lhs, std::vector<T> const &rhs) -> std::vector<result_type> {
+        std::vector<result_type> result(std::min(lhs.size(), rhs.size()));
+        operator()(std::span<T const>(lhs), std::span<T const>(rhs), std::span<result_type>(result));
+        return result;
+    }
+};
 
 
 #endif
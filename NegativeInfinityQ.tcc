@@ -11,8 +11,8 @@ namespace Predicates {
 
     private:
         /// The Negative infinity value for the given type N
-        static const constinit auto
-        neg_inf = std::numeric_limits<N>::infinity();
+        static constexpr auto
+        neg_inf = -std::numeric_limits<N>::infinity();
 
     public:
         constexpr static auto operator()(N const &n) -> bool;
@@ -22,4 +22,20 @@ namespace Predicates {
     };
 }
 
+
+/* Definitions live with the declarations so every translation unit can instantiate the predicate */
+namespace Predicates {
+
+    template<typename N>
+    constexpr auto NegativeInfinityQ<N>::operator()(const N &n) -> bool {
+        return n == neg_inf;
+    }
+
+    template<typename N>
+    constexpr auto NegativeInfinityQ<N>::operator()(const N &lhs, const N &rhs) -> bool {
+        return NegativeInfinityQ<N>::operator()(lhs) || NegativeInfinityQ<N>::operator()(rhs);
+    }
+
+}
+
 #endif
\ No newline at end of file
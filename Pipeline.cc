@@ -0,0 +1 @@
+#include "Pipeline.tcc"
@@ -0,0 +1,350 @@
+#ifndef THREADED_PIPELINE_TCC
+#define THREADED_PIPELINE_TCC
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+#include "CpuDispatch.tcc"
+#include "HugePageResource.tcc"
+#include "NPlus.tcc"
+#include "NegativeInfinityQ.tcc"
+#include "PositiveInfinityQ.tcc"
+#include "ThreadPool.tcc"
+
+
+enum class PipelineSchedule : std::uint8_t {
+    Fused = 0,   ///< every stage runs on one tile while it is in cache, then the next tile
+    Staged = 1,  ///< every stage runs over the whole input, through full-size intermediates
+};
+
+
+struct PipelineOptions {
+    /// Elements per tile; 0 sizes tiles so one tile's operands and intermediates fill half of L2
+    std::size_t tile = 0;
+    PipelineSchedule schedule = PipelineSchedule::Fused;
+    bool threaded = true;
+    Priority priority = Priority::Normal;
+};
+
+
+/// @brief Outcome of a reduction: the value over the lanes no stage flagged, and how many were flagged
+template<typename Acc>
+struct PipelineResult {
+    Acc value;
+    std::size_t flagged = 0;
+    std::size_t elements = 0;
+};
+
+
+/// @brief One tile as the stages see it: operands, the running values and the flags of lanes ruled out so far
+template<typename T, typename V>
+struct PipelineTile {
+    using operand_type = T;
+    using value_type = V;
+
+    std::size_t offset;
+    std::span<T const> lhs;
+    std::span<T const> rhs;
+    std::span<V> values;
+    std::span<std::uint8_t> flags;
+};
+
+
+/// Stages a Pipeline can chain. Each one transforms a PipelineTile in place and never looks outside it.
+namespace PipelineStage {
+
+    /// @brief flags[i] |= Predicate(lhs[i], rhs[i]), e.g. Predicates::PositiveInfinityQ
+    template<typename Predicate>
+    struct Classify {
+        template<typename Tile>
+        auto operator()(Tile &tile) const -> void {
+            for (std::size_t i = 0; i < tile.flags.size(); ++i) {
+                tile.flags[i] |= static_cast<std::uint8_t>(Predicate{}(tile.lhs[i], tile.rhs[i]));
+            }
+        }
+    };
+
+    /// @brief flags[i] |= lhs[i] + rhs[i] leaves the range in either direction, or an operand is not finite
+    /// (CpuDispatch::overflow_check or underflow_check, in one pass)
+    struct RangeCheck {
+        template<typename Tile>
+        auto operator()(Tile &tile) const -> void {
+            using T = typename Tile::operand_type;
+            using Add = NPlus<T, OverflowPolicy::Wrap>;
+            for (std::size_t i = 0; i < tile.flags.size(); ++i) {
+                auto lhs = tile.lhs[i];
+                auto rhs = tile.rhs[i];
+                bool special = !(CpuDispatch::detail::finite(lhs) && CpuDispatch::detail::finite(rhs));
+                bool overflow = Add::overflowed(lhs, rhs, Add::wrapping_add(lhs, rhs));
+                tile.flags[i] |= static_cast<std::uint8_t>(special | overflow);
+            }
+        }
+    };
+
+    /// @brief values = NPlus<T, Policy>(lhs, rhs), through the CpuDispatch build for this machine
+    template<OverflowPolicy Policy>
+    struct Add {
+        template<typename Tile>
+        auto operator()(Tile &tile) const -> void {
+            using T = typename Tile::operand_type;
+            CpuDispatch::nplus<T, Policy>(tile.lhs, tile.rhs, tile.values);
+        }
+    };
+
+    /// @brief values[i] = fn(values[i])
+    template<typename F>
+    struct Map {
+        F fn;
+
+        template<typename Tile>
+        auto operator()(Tile &tile) const -> void {
+            for (auto &value: tile.values) {
+                value = fn(value);
+            }
+        }
+    };
+}
+
+
+/// @brief Lazy chain of element-wise stages over a pair of operand arrays, run by a terminal call.
+///
+/// Building the chain only records stages; reduce(), count() or materialize() run it. In the Fused schedule
+/// each worker takes a tile, pushes it through every stage and the terminal, then moves on, so values and
+/// flags live in a per-thread scratch tile that stays in L2 and no full-size intermediate is ever written.
+/// The Staged schedule runs the same stages one after another over full-length buffers, which is what
+/// calling the kernels separately costs; it exists for A/B comparison.
+///
+/// Tile boundaries depend only on the input size and the tile length, and reductions combine per-tile
+/// partials in tile order, so results do not depend on the thread count. Stages must not run pipelines
+/// themselves: the scratch tile belongs to the thread.
+///
+/// R is the value type produced by the add stage, void until one has been chained.
+template<typename T, typename R, typename... Stages> requires std::is_arithmetic_v<T>
+class Pipeline {
+
+public: /* Public types */
+
+    using value_type = R;
+
+private: /* Private types */
+
+    static constexpr bool has_values = !std::is_void_v<R>;
+
+    /// Element type of the values scratch; a placeholder while there are no values
+    using V = std::conditional_t<has_values, R, std::uint8_t>;
+
+    using Tile = PipelineTile<T, V>;
+
+private: /* Private Members */
+
+    std::span<T const> m_lhs;
+    std::span<T const> m_rhs;
+    std::tuple<Stages...> m_stages;
+    PipelineOptions m_options;
+
+private: /* Private Methods */
+
+    static auto l2_bytes() -> std::size_t {
+        static auto const bytes = [] {
+            long reported = 0;
+#if defined(__linux__) && defined(_SC_LEVEL2_CACHE_SIZE)
+            reported = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+            return reported > 0 ? static_cast<std::size_t>(reported) : std::size_t{1} << 20;
+        }();
+        return bytes;
+    }
+
+    auto tile_size() const -> std::size_t {
+        if (m_options.tile != 0) {
+            return m_options.tile;
+        }
+        constexpr auto per_element = 2 * sizeof(T) + (has_values ? sizeof(V) : 0) + 1;
+        return std::max<std::size_t>(l2_bytes() / 2 / per_element / 256 * 256, 256);
+    }
+
+    /// @brief Values and flags scratch of the calling thread, at least length elements each
+    static auto scratch(std::size_t length) -> std::pair<V *, std::uint8_t *> {
+        thread_local std::vector<V> values;
+        thread_local std::vector<std::uint8_t> flags;
+        if (flags.size() < length) {
+            flags.resize(length);
+            if constexpr (has_values) {
+                values.resize(length);
+            }
+        }
+        return {values.data(), flags.data()};
+    }
+
+    template<typename Body>
+    auto for_tiles(std::size_t tiles, Body &&body) const -> void {
+        if (m_options.threaded) {
+            ThreadPool::shared().for_each_index(tiles, body, m_options.priority);
+        } else {
+            for (std::size_t t = 0; t < tiles; ++t) {
+                body(t);
+            }
+        }
+    }
+
+    /// @brief Push every tile through the stages, then hand it to finish(tile index, tile)
+    /// @return the number of flagged lanes
+    template<typename Finish>
+    auto execute(Finish &&finish) const -> std::size_t {
+        auto n = size();
+        auto tile = tile_size();
+        auto tiles = (n + tile - 1) / tile;
+        std::atomic<std::size_t> flagged{0};
+
+        auto close = [&](std::size_t t, Tile &view) {
+            std::size_t count = 0;
+            for (auto flag: view.flags) {
+                count += flag != 0;
+            }
+            flagged.fetch_add(count, std::memory_order_relaxed);
+            finish(t, view);
+        };
+
+        if (m_options.schedule == PipelineSchedule::Fused) {
+            for_tiles(tiles, [&](std::size_t t) {
+                auto begin = t * tile;
+                auto len = std::min(tile, n - begin);
+                auto [values, flags] = scratch(len);
+                Tile view{begin, m_lhs.subspan(begin, len), m_rhs.subspan(begin, len),
+                          std::span<V>(values, has_values ? len : 0), std::span<std::uint8_t>(flags, len)};
+                std::fill(view.flags.begin(), view.flags.end(), std::uint8_t{0});
+                std::apply([&](auto const &...stage) { (stage(view), ...); }, m_stages);
+                close(t, view);
+            });
+        } else {
+            HugeBuffer<V> values(has_values ? n : 0);
+            HugeBuffer<std::uint8_t> flags(n);
+            auto view_of = [&](std::size_t t) {
+                auto begin = t * tile;
+                auto len = std::min(tile, n - begin);
+                return Tile{begin, m_lhs.subspan(begin, len), m_rhs.subspan(begin, len),
+                            has_values ? std::span<V>(values).subspan(begin, len) : std::span<V>(),
+                            std::span<std::uint8_t>(flags).subspan(begin, len)};
+            };
+            for_tiles(tiles, [&](std::size_t t) {
+                auto view = view_of(t);
+                std::fill(view.flags.begin(), view.flags.end(), std::uint8_t{0});
+            });
+            std::apply([&](auto const &...stage) {
+                (for_tiles(tiles, [&](std::size_t t) {
+                    auto view = view_of(t);
+                    stage(view);
+                }), ...);
+            }, m_stages);
+            for_tiles(tiles, [&](std::size_t t) {
+                auto view = view_of(t);
+                close(t, view);
+            });
+        }
+        return flagged.load(std::memory_order_relaxed);
+    }
+
+    template<typename R2, typename Stage>
+    auto then(Stage stage) const -> Pipeline<T, R2, Stages..., Stage> {
+        auto stages = std::tuple_cat(m_stages, std::tuple<Stage>(std::move(stage)));
+        return Pipeline<T, R2, Stages..., Stage>(m_lhs, m_rhs, std::move(stages), m_options);
+    }
+
+public: /* Constructors */
+
+    Pipeline(std::span<T const> lhs, std::span<T const> rhs, std::tuple<Stages...> stages = {},
+             PipelineOptions options = {})
+            : m_lhs(lhs.first(std::min(lhs.size(), rhs.size()))), m_rhs(rhs.first(std::min(lhs.size(), rhs.size()))),
+              m_stages(std::move(stages)), m_options(options) {}
+
+public: /* Public Methods */
+
+    auto size() const noexcept -> std::size_t { return m_lhs.size(); }
+
+    auto with(PipelineOptions options) const -> Pipeline {
+        return Pipeline(m_lhs, m_rhs, m_stages, options);
+    }
+
+    /// @brief Flag lanes where Predicate holds for either operand, e.g. Predicates::PositiveInfinityQ<T>
+    template<typename Predicate>
+    auto classify() const { return then<R>(PipelineStage::Classify<Predicate>{}); }
+
+    /// @brief Flag lanes whose sum overflows or that have a non-finite operand
+    auto check_range() const { return then<R>(PipelineStage::RangeCheck{}); }
+
+    /// @brief Compute the values as NPlus<T, Policy>(lhs, rhs)
+    template<OverflowPolicy Policy = default_overflow_policy<T>>
+    auto add() const requires (!has_values) {
+        return then<typename NPlus<T, Policy>::result_type>(PipelineStage::Add<Policy>{});
+    }
+
+    /// @brief Replace every value by fn(value)
+    template<typename F> requires std::is_invocable_r_v<V, F const &, V>
+    auto map(F fn) const requires has_values {
+        return then<R>(PipelineStage::Map<F>{std::move(fn)});
+    }
+
+    /// @brief Number of lanes flagged by any stage
+    auto count() const -> std::size_t {
+        return execute([](std::size_t, Tile &) {});
+    }
+
+    /// @brief Fold op over the values of unflagged lanes. init must be an identity of op: every tile starts
+    /// from it, and the tile results are folded together in order starting from it again.
+    template<typename Acc, typename Op>
+    auto reduce(Acc init, Op op) const -> PipelineResult<Acc> requires has_values {
+        auto tile = tile_size();
+        std::vector<Acc> partials((size() + tile - 1) / tile, init);
+        auto flagged = execute([&](std::size_t t, Tile &view) {
+            Acc acc = init;
+            for (std::size_t i = 0; i < view.values.size(); ++i) {
+                if (!view.flags[i]) {
+                    acc = op(acc, view.values[i]);
+                }
+            }
+            partials[t] = acc;
+        });
+        for (auto const &partial: partials) {
+            init = op(init, partial);
+        }
+        return {init, flagged, size()};
+    }
+
+    /// @brief Sum of the values of unflagged lanes
+    auto sum() const -> PipelineResult<V> requires has_values {
+        return reduce(V{}, [](V acc, V value) { return acc + value; });
+    }
+
+    /// @brief Write the final values and flags out, for callers that do need them in memory
+    /// @return the number of flagged lanes
+    auto materialize(std::span<V> out, std::span<std::uint8_t> out_flags) const -> std::size_t requires has_values {
+        return execute([&](std::size_t, Tile &view) {
+            auto len = std::min(view.values.size(), out.size() - std::min(out.size(), view.offset));
+            std::copy_n(view.values.begin(), len, out.begin() + static_cast<std::ptrdiff_t>(view.offset));
+            len = std::min(view.flags.size(), out_flags.size() - std::min(out_flags.size(), view.offset));
+            std::copy_n(view.flags.begin(), len, out_flags.begin() + static_cast<std::ptrdiff_t>(view.offset));
+        });
+    }
+};
+
+
+/// @brief Start a pipeline over lhs and rhs (truncated to the shorter of the two)
+template<typename T> requires std::is_arithmetic_v<T>
+auto pipeline(std::span<T const> lhs, std::span<T const> rhs, PipelineOptions options = {}) -> Pipeline<T, void> {
+    return Pipeline<T, void>(lhs, rhs, {}, options);
+}
+
+
+#endif
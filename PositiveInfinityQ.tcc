@@ -11,7 +11,7 @@ namespace Predicates {
 
     private:
         /// The positive infinity value for the given type N
-        static const constinit auto
+        static constexpr auto
         pos_inf = std::numeric_limits<N>::infinity();
 
     public:
@@ -22,4 +22,20 @@ namespace Predicates {
     };
 }
 
+
+/* Definitions live with the declarations so every translation unit can instantiate the predicate */
+namespace Predicates {
+
+    template<typename N>
+    constexpr auto PositiveInfinityQ<N>::operator()(const N &n) -> bool {
+        return n == pos_inf;
+    }
+
+    template<typename N>
+    constexpr auto PositiveInfinityQ<N>::operator()(const N &lhs, const N &rhs) -> bool {
+        return PositiveInfinityQ<N>::operator()(lhs) || PositiveInfinityQ<N>::operator()(rhs);
+    }
+
+}
+
 #endif
\ No newline at end of file
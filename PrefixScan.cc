@@ -0,0 +1 @@
+#include "PrefixScan.tcc"
@@ -0,0 +1,178 @@
+#ifndef THREADED_PREFIX_SCAN_TCC
+#define THREADED_PREFIX_SCAN_TCC
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "NPlus.tcc"
+#include "Reproducible.tcc"
+#include "ThreadPool.tcc"
+
+
+/// @brief Parallel inclusive/exclusive prefix sums that report where the running total overflowed.
+///
+/// Three passes over the pool: every chunk reduces to a partial sum, the partials are scanned into chunk
+/// offsets, then every chunk is rescanned from its offset. Sums wrap (integers) or follow IEEE (floating
+/// point) exactly like NPlus<T, OverflowPolicy::Wrap>; the returned index is the first i for which the exact
+/// running sum in[0] + ... + in[i] is not representable in T.
+///
+/// Integer wrapping addition is associative, so up to the first overflow every chunk offset is exact, the
+/// first overflow seen inside a chunk is the true one for that chunk and the smallest index over all chunks is
+/// the global answer. Floating point partials add in another order than the sequential scan and can leave the
+/// finite range where the sequential sum does not; when any chunk offset is not finite the range is rescanned
+/// in one sequential pass instead of reporting that artifact.
+///
+/// Floating point results depend on the chunk boundaries; in Reproducible::Mode::Deterministic they are a
+/// function of the input length only, so the output is the same on any number of threads.
+template<typename T> requires std::is_arithmetic_v<T>
+class PrefixScan {
+
+private: /* Private types */
+
+    using Add = NPlus<T, OverflowPolicy::Wrap>;
+
+private: /* Private Members */
+
+    /// Elements per chunk below which splitting across the pool does not pay off
+    static constexpr std::size_t min_chunk = 1 << 15;
+
+    /// Elements per rescan block; the overflow flags of one block are evaluated in a single vector loop
+    static constexpr std::size_t block = 256;
+
+    /// Independent accumulators in the reduce pass so the loop vectorizes
+    static constexpr std::size_t lanes = 8;
+
+private: /* Private Methods */
+
+    static auto reduce(T const *in, std::size_t n) -> T {
+        std::array<T, lanes> acc{};
+        std::size_t i = 0;
+        for (; i + lanes <= n; i += lanes) {
+            for (std::size_t l = 0; l < lanes; ++l) {
+                acc[l] = Add::wrapping_add(acc[l], in[i + l]);
+            }
+        }
+        T total{};
+        for (auto a: acc) {
+            total = Add::wrapping_add(total, a);
+        }
+        for (; i < n; ++i) {
+            total = Add::wrapping_add(total, in[i]);
+        }
+        return total;
+    }
+
+    /// @brief Scan one chunk starting from offset; returns the chunk-relative index of the first overflow
+    template<bool Inclusive>
+    static auto rescan(T const *in, T *out, std::size_t n, T offset) -> std::optional<std::size_t> {
+        std::optional<std::size_t> first;
+        T running = offset;
+
+        for (std::size_t base = 0; base < n; base += block) {
+            auto len = std::min(block, n - base);
+            std::array<T, block + 1> sums;
+            sums[0] = running;
+
+            /* The carried dependency stays scalar; everything around it is element-wise */
+            for (std::size_t i = 0; i < len; ++i) {
+                sums[i + 1] = Add::wrapping_add(sums[i], in[base + i]);
+            }
+            for (std::size_t i = 0; i < len; ++i) {
+                out[base + i] = Inclusive ? sums[i + 1] : sums[i];
+            }
+
+            if (!first) {
+                bool any = false;
+                for (std::size_t i = 0; i < len; ++i) {
+                    any |= Add::overflowed(sums[i], in[base + i], sums[i + 1]);
+                }
+                if (any) {
+                    for (std::size_t i = 0; i < len; ++i) {
+                        if (Add::overflowed(sums[i], in[base + i], sums[i + 1])) {
+                            first = base + i;
+                            break;
+                        }
+                    }
+                }
+            }
+            running = sums[len];
+        }
+        return first;
+    }
+
+    template<bool Inclusive>
+    static auto scan(std::span<T const> in, std::span<T> out, T init, Reproducible::Mode mode, ThreadPool &pool)
+    -> std::optional<std::size_t> {
+        auto n = std::min(in.size(), out.size());
+        auto chunks = Reproducible::chunk_count(n, min_chunk, pool, mode);
+
+        auto bounds = [&](std::size_t c) { return std::pair{n * c / chunks, n * (c + 1) / chunks}; };
+
+        if (chunks == 1) {
+            return rescan<Inclusive>(in.data(), out.data(), n, init);
+        }
+
+        /* Pass 1: chunk partial sums */
+        std::vector<T> offsets(chunks + 1);
+        pool.for_each_index(chunks, [&](std::size_t c) {
+            auto [begin, end] = bounds(c);
+            offsets[c + 1] = reduce(in.data() + begin, end - begin);
+        });
+
+        /* Pass 2: exclusive scan of the partials gives each chunk its starting offset */
+        offsets[0] = init;
+        for (std::size_t c = 1; c <= chunks; ++c) {
+            offsets[c] = Add::wrapping_add(offsets[c - 1], offsets[c]);
+        }
+
+        /* A non-finite floating point offset may be an artifact of the chunked order: fall back to one pass */
+        if constexpr (std::is_floating_point_v<T>) {
+            if (!std::ranges::all_of(offsets, [](T offset) { return std::isfinite(offset); })) {
+                return rescan<Inclusive>(in.data(), out.data(), n, init);
+            }
+        }
+
+        /* Pass 3: rescan every chunk from its offset */
+        std::vector<std::optional<std::size_t>> first(chunks);
+        pool.for_each_index(chunks, [&](std::size_t c) {
+            auto [begin, end] = bounds(c);
+            if (auto local = rescan<Inclusive>(in.data() + begin, out.data() + begin, end - begin, offsets[c])) {
+                first[c] = begin + *local;
+            }
+        });
+
+        for (auto const &f: first) {
+            if (f) {
+                return f;
+            }
+        }
+        return std::nullopt;
+    }
+
+public: /* Public Methods */
+
+    /// @brief out[i] = init + in[0] + ... + in[i]
+    /// @return the first index whose running sum overflowed T, if any
+    static auto inclusive(std::span<T const> in, std::span<T> out, T init = T{},
+                          Reproducible::Mode mode = Reproducible::mode(),
+                          ThreadPool &pool = ThreadPool::shared()) -> std::optional<std::size_t> {
+        return scan<true>(in, out, init, mode, pool);
+    }
+
+    /// @brief out[i] = init + in[0] + ... + in[i - 1]
+    /// @return the first index whose running sum (including in[i]) overflowed T, if any
+    static auto exclusive(std::span<T const> in, std::span<T> out, T init = T{},
+                          Reproducible::Mode mode = Reproducible::mode(),
+                          ThreadPool &pool = ThreadPool::shared()) -> std::optional<std::size_t> {
+        return scan<false>(in, out, init, mode, pool);
+    }
+};
+
+
+#endif
@@ -0,0 +1 @@
+#include "RadixDataArray.tcc"
@@ -0,0 +1,386 @@
+#ifndef THREADED_RADIX_DATA_ARRAY_TCC
+#define THREADED_RADIX_DATA_ARRAY_TCC
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+/// @brief Minimal allocator handing out Align-byte aligned storage, for SIMD-friendly field arrays
+template<typename U, std::size_t Align = 64>
+struct AlignedAllocator {
+    using value_type = U;
+
+    template<typename V>
+    struct rebind {
+        using other = AlignedAllocator<V, Align>;
+    };
+
+    constexpr AlignedAllocator() noexcept = default;
+
+    template<typename V>
+    constexpr AlignedAllocator(AlignedAllocator<V, Align> const &) noexcept {}
+
+    auto allocate(std::size_t n) -> U * {
+        return static_cast<U *>(::operator new(n * sizeof(U), std::align_val_t{Align}));
+    }
+
+    auto deallocate(U *p, std::size_t) noexcept -> void { ::operator delete(p, std::align_val_t{Align}); }
+
+    template<typename V>
+    friend constexpr auto operator==(AlignedAllocator const &, AlignedAllocator<V, Align> const &) noexcept -> bool {
+        return true;
+    }
+};
+
+
+/// @brief Structure-of-arrays store for RadixData records.
+///
+/// Each record is the value mantissa * radix^exponent plus its raw data word. Every field lives in its own
+/// contiguous 64-byte aligned array, so a pass over one field streams only that field; the radix (2..16) is
+/// packed into a nibble, two records per byte. Iteration yields proxy references over all four fields.
+template<typename T, std::unsigned_integral Mantissa = std::uint32_t, std::signed_integral Exponent = std::int32_t>
+class RadixDataArray {
+
+public: /* Public types */
+
+    /// @brief One record by value
+    struct Record {
+        T data{};
+        std::size_t radix = 2;
+        Mantissa mantissa = 0;
+        Exponent exponent = 0;
+
+        friend constexpr auto operator==(Record const &, Record const &) noexcept -> bool = default;
+    };
+
+    /// @brief Proxy to the fields of one stored record
+    class Reference {
+        RadixDataArray *m_array;
+        std::size_t m_index;
+
+    public:
+        Reference(RadixDataArray *array, std::size_t index) noexcept: m_array(array), m_index(index) {}
+
+        auto data() const noexcept -> T & { return m_array->m_data[m_index]; }
+
+        auto mantissa() const noexcept -> Mantissa & { return m_array->m_mantissa[m_index]; }
+
+        auto exponent() const noexcept -> Exponent & { return m_array->m_exponent[m_index]; }
+
+        auto radix() const noexcept -> std::size_t { return m_array->radix(m_index); }
+
+        auto set_radix(std::size_t radix) const -> void { m_array->set_radix(m_index, radix); }
+
+        operator Record() const { return {data(), radix(), mantissa(), exponent()}; }
+
+        auto operator=(Record const &record) const -> Reference const & {
+            data() = record.data;
+            set_radix(record.radix);
+            mantissa() = record.mantissa;
+            exponent() = record.exponent;
+            return *this;
+        }
+
+        /* Assigning one proxy to another copies the record, it does not rebind */
+        auto operator=(Reference const &other) const -> Reference const & { return *this = Record(other); }
+
+        Reference(Reference const &) noexcept = default;
+
+        friend auto swap(Reference lhs, Reference rhs) -> void {
+            Record tmp = lhs;
+            lhs = Record(rhs);
+            rhs = tmp;
+        }
+    };
+
+    /// @brief Zip iterator over all four field arrays
+    class Iterator {
+        RadixDataArray *m_array = nullptr;
+        std::size_t m_index = 0;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Record;
+        using difference_type = std::ptrdiff_t;
+        using reference = Reference;
+
+        Iterator() noexcept = default;
+
+        Iterator(RadixDataArray *array, std::size_t index) noexcept: m_array(array), m_index(index) {}
+
+        auto operator*() const noexcept -> Reference { return {m_array, m_index}; }
+
+        auto operator[](difference_type n) const noexcept -> Reference { return *(*this + n); }
+
+        auto operator++() noexcept -> Iterator & { ++m_index; return *this; }
+
+        auto operator++(int) noexcept -> Iterator { auto copy = *this; ++m_index; return copy; }
+
+        auto operator--() noexcept -> Iterator & { --m_index; return *this; }
+
+        auto operator--(int) noexcept -> Iterator { auto copy = *this; --m_index; return copy; }
+
+        auto operator+=(difference_type n) noexcept -> Iterator & { m_index += n; return *this; }
+
+        auto operator-=(difference_type n) noexcept -> Iterator & { m_index -= n; return *this; }
+
+        friend auto operator+(Iterator it, difference_type n) noexcept -> Iterator { return it += n; }
+
+        friend auto operator+(difference_type n, Iterator it) noexcept -> Iterator { return it += n; }
+
+        friend auto operator-(Iterator it, difference_type n) noexcept -> Iterator { return it -= n; }
+
+        friend auto operator-(Iterator const &lhs, Iterator const &rhs) noexcept -> difference_type {
+            return static_cast<difference_type>(lhs.m_index) - static_cast<difference_type>(rhs.m_index);
+        }
+
+        friend auto operator==(Iterator const &lhs, Iterator const &rhs) noexcept -> bool {
+            return lhs.m_index == rhs.m_index;
+        }
+
+        friend auto operator<=>(Iterator const &lhs, Iterator const &rhs) noexcept {
+            return lhs.m_index <=> rhs.m_index;
+        }
+    };
+
+private: /* Private Members */
+
+    template<typename U>
+    using Field = std::vector<U, AlignedAllocator<U>>;
+
+    Field<T> m_data{};
+    Field<std::uint8_t> m_radix{};
+    Field<Mantissa> m_mantissa{};
+    Field<Exponent> m_exponent{};
+
+private: /* Private Methods */
+
+    static auto check_radix(std::size_t radix) -> void {
+        if (radix < 2 || radix > 16) {
+            throw std::invalid_argument("RadixDataArray: radix must be in 2..16");
+        }
+    }
+
+    /// @brief mantissa * radix^exponent in the same radix with the widest mantissa, or with trailing zero digits
+    /// dropped while the exponent is negative
+    static auto same_radix(Mantissa mantissa, std::int64_t exponent, Mantissa radix)
+    -> std::pair<Mantissa, std::int64_t> {
+        Mantissa next;
+        while (exponent > 0 && !__builtin_mul_overflow(mantissa, radix, &next)) {
+            mantissa = next;
+            --exponent;
+        }
+        while (exponent < 0 && mantissa % radix == 0) {
+            mantissa /= radix;
+            ++exponent;
+        }
+        return {mantissa, exponent};
+    }
+
+    /// @brief mantissa * 2^bits as m * 2^(target_bits * e) with m widest in Mantissa, rounded to nearest
+    /// @return {m, e}
+    static auto shift_radix(Mantissa mantissa, std::int64_t bits, int target_bits)
+    -> std::pair<Mantissa, std::int64_t> {
+        constexpr int digits = std::numeric_limits<Mantissa>::digits;
+        using Wide = unsigned __int128;
+
+        /* Smallest e that leaves the value's top bit inside the mantissa */
+        auto excess = static_cast<std::int64_t>(std::bit_width(mantissa)) + bits - digits;
+        auto exponent = excess >= 0 ? (excess + target_bits - 1) / target_bits : -(-excess / target_bits);
+        auto shift = bits - exponent * target_bits;
+
+        Wide m = mantissa;
+        if (shift >= 0) {
+            m <<= shift;
+        } else {
+            auto drop = static_cast<int>(-shift);
+            m = (m + (Wide{1} << (drop - 1))) >> drop;
+        }
+        if (m >> digits) {
+            m >>= target_bits;
+            exponent += 1;
+        }
+
+        /* Drop trailing zero digits so exactly representable values keep their exact mantissa */
+        auto digit_mask = (Wide{1} << target_bits) - 1;
+        while (exponent < 0 && (m & digit_mask) == 0) {
+            m >>= target_bits;
+            exponent += 1;
+        }
+        return {static_cast<Mantissa>(m), exponent};
+    }
+
+public: /* Constructors */
+
+    RadixDataArray() = default;
+
+    explicit RadixDataArray(std::size_t n, Record const &fill = {}) { resize(n, fill); }
+
+public: /* Public Methods */
+
+    auto size() const noexcept -> std::size_t { return m_data.size(); }
+
+    auto empty() const noexcept -> bool { return m_data.empty(); }
+
+    auto reserve(std::size_t n) -> void {
+        m_data.reserve(n);
+        m_radix.reserve((n + 1) / 2);
+        m_mantissa.reserve(n);
+        m_exponent.reserve(n);
+    }
+
+    auto resize(std::size_t n, Record const &fill = {}) -> void {
+        check_radix(fill.radix);
+        auto old = size();
+        m_data.resize(n, fill.data);
+        m_radix.resize((n + 1) / 2);
+        m_mantissa.resize(n, fill.mantissa);
+        m_exponent.resize(n, fill.exponent);
+        for (auto i = old; i < n; ++i) {
+            set_radix(i, fill.radix);
+        }
+    }
+
+    auto push_back(Record const &record) -> void {
+        check_radix(record.radix);
+        auto i = size();
+        m_data.push_back(record.data);
+        if (i % 2 == 0) {
+            m_radix.push_back(0);
+        }
+        m_mantissa.push_back(record.mantissa);
+        m_exponent.push_back(record.exponent);
+        set_radix(i, record.radix);
+    }
+
+    /// @brief Radix of record i; stored as radix - 1 in the low (even i) or high (odd i) nibble
+    auto radix(std::size_t i) const noexcept -> std::size_t {
+        return ((m_radix[i / 2] >> (4 * (i % 2))) & 0xF) + 1;
+    }
+
+    auto set_radix(std::size_t i, std::size_t radix) -> void {
+        check_radix(radix);
+        auto shift = 4 * (i % 2);
+        auto &byte = m_radix[i / 2];
+        byte = static_cast<std::uint8_t>((byte & ~(0xF << shift)) | ((radix - 1) << shift));
+    }
+
+    auto operator[](std::size_t i) noexcept -> Reference { return {this, i}; }
+
+    auto at(std::size_t i) -> Reference {
+        if (i >= size()) {
+            throw std::out_of_range("RadixDataArray::at");
+        }
+        return {this, i};
+    }
+
+    auto begin() noexcept -> Iterator { return {this, 0}; }
+
+    auto end() noexcept -> Iterator { return {this, size()}; }
+
+    /* Whole-field views for passes that touch a single field */
+
+    auto data() noexcept -> std::span<T> { return m_data; }
+
+    auto data() const noexcept -> std::span<T const> { return m_data; }
+
+    auto mantissas() noexcept -> std::span<Mantissa> { return m_mantissa; }
+
+    auto mantissas() const noexcept -> std::span<Mantissa const> { return m_mantissa; }
+
+    auto exponents() noexcept -> std::span<Exponent> { return m_exponent; }
+
+    auto exponents() const noexcept -> std::span<Exponent const> { return m_exponent; }
+
+    /// @brief Add delta to every exponent, saturating at the limits of Exponent
+    auto rescale_exponents(Exponent delta) noexcept -> void {
+        constexpr auto lo = std::numeric_limits<Exponent>::min();
+        constexpr auto hi = std::numeric_limits<Exponent>::max();
+        for (auto &e: m_exponent) {
+            Exponent sum;
+            e = __builtin_add_overflow(e, delta, &sum) ? (delta > 0 ? hi : lo) : sum;
+        }
+    }
+
+    /// @brief Set every radix to radix without touching the other fields
+    auto fill_radix(std::size_t radix) -> void {
+        check_radix(radix);
+        auto both = static_cast<std::uint8_t>((radix - 1) * 0x11);
+        std::fill(m_radix.begin(), m_radix.end(), both);
+    }
+
+    /// @brief Re-express every value mantissa * radix^exponent in the given radix.
+    ///
+    /// The new mantissa keeps as many digits as fit in Mantissa and is rounded to nearest (ties away from
+    /// zero). Integer values that fit in Mantissa, conversions to the same radix and conversions between
+    /// power-of-two radixes are done in integer arithmetic and are exact whenever the digits fit; the other
+    /// values go through long double logarithms. Zero mantissas get exponent 0.
+    auto convert_radix(std::size_t target) -> void {
+        static_assert(std::numeric_limits<Mantissa>::digits <= std::numeric_limits<long double>::digits,
+                      "RadixDataArray::convert_radix needs every Mantissa to be exact in long double");
+        check_radix(target);
+        constexpr int digits = std::numeric_limits<Mantissa>::digits;
+        auto log2_target = std::log2(static_cast<long double>(target));
+        auto target_bits = std::has_single_bit(target) ? std::countr_zero(target) : 0;
+
+        for (std::size_t i = 0; i < size(); ++i) {
+            if (m_mantissa[i] == 0) {
+                m_exponent[i] = 0;
+                continue;
+            }
+            auto source = radix(i);
+            std::optional<std::pair<Mantissa, std::int64_t>> exact;
+            if (source == target) {
+                exact = same_radix(m_mantissa[i], m_exponent[i], static_cast<Mantissa>(target));
+            } else if (target_bits != 0 && std::has_single_bit(source)) {
+                exact = shift_radix(m_mantissa[i], static_cast<std::int64_t>(m_exponent[i]) * std::countr_zero(source),
+                                    target_bits);
+            } else if (m_exponent[i] >= 0) {
+                /* An integer value that fits is its own mantissa */
+                auto [value, left] = same_radix(m_mantissa[i], m_exponent[i], static_cast<Mantissa>(source));
+                if (left == 0) {
+                    exact = std::pair{value, std::int64_t{0}};
+                }
+            }
+            if (exact) {
+                m_mantissa[i] = exact->first;
+                m_exponent[i] = static_cast<Exponent>(exact->second);
+                continue;
+            }
+
+            auto log2_value = std::log2(static_cast<long double>(m_mantissa[i])) +
+                              static_cast<long double>(m_exponent[i]) * std::log2(static_cast<long double>(radix(i)));
+            auto exponent = std::ceil((log2_value - digits) / log2_target);
+            auto mantissa = std::round(std::exp2(log2_value - exponent * log2_target));
+
+            /* Drop trailing zero digits so exactly representable values keep their exact mantissa */
+            while (exponent < 0 && std::fmod(mantissa, static_cast<long double>(target)) == 0) {
+                mantissa /= static_cast<long double>(target);
+                exponent += 1;
+            }
+            /* 2^digits is exact in long double, unlike Mantissa's max, so the cast below stays in range */
+            if (mantissa >= std::ldexp(1.0L, digits)) {
+                mantissa = std::round(mantissa / static_cast<long double>(target));
+                exponent += 1;
+            }
+            m_mantissa[i] = static_cast<Mantissa>(mantissa);
+            m_exponent[i] = static_cast<Exponent>(exponent);
+        }
+        fill_radix(target);
+    }
+};
+
+
+#endif
@@ -0,0 +1 @@
+#include "RadixParse.tcc"
@@ -0,0 +1,256 @@
+#ifndef THREADED_RADIX_PARSE_TCC
+#define THREADED_RADIX_PARSE_TCC
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "ArithmeticRadix.tcc"
+#include "Instrumentation.tcc"
+
+
+enum class ParseStatus : std::uint8_t {
+    Ok = 0,
+    Empty = 1,
+    InvalidDigit = 2,
+    Overflow = 3,
+};
+
+
+/// @brief String to integer parsing for the radices 2 through 16 (the same set covered by radix_map).
+///
+/// Digits are validated and folded 16 characters at a time: the characters are mapped onto digit values
+/// in one vector, range-checked against the radix with a single unsigned max/compare, then combined with
+/// two rounds of pairwise multiply-add (digit pairs, then pairs of pairs) so only four partial values are
+/// left for the scalar, overflow-checked accumulation.
+template<std::integral T>
+class RadixParse {
+
+private: /* Private types */
+
+    using Magnitude = std::conditional_t<(sizeof(T) <= 4), std::uint32_t, std::uint64_t>;
+    using Parser = auto (*)(char const *, std::size_t, Magnitude) -> std::pair<Magnitude, ParseStatus>;
+
+private: /* Private Members */
+
+    /// The smallest and largest radix accepted
+    static constexpr std::size_t min_radix = 2;
+    static constexpr std::size_t max_radix = 16;
+
+    /// Characters folded per vector step
+    static constexpr std::size_t chunk = 16;
+
+    /// Map from character to digit value, 0xFF for anything that is not a digit in radix 16
+    static constexpr std::array<std::uint8_t, 256> digit_table = [] {
+        std::array<std::uint8_t, 256> table{};
+        table.fill(0xFF);
+        for (std::uint8_t c = 0; c < 10; ++c) {
+            table['0' + c] = c;
+        }
+        for (std::uint8_t c = 0; c < 6; ++c) {
+            table['a' + c] = 10 + c;
+            table['A' + c] = 10 + c;
+        }
+        return table;
+    }();
+
+private: /* Private Methods */
+
+    /// @brief Fold exactly 16 characters into their value; false if any character is not a Base digit
+    template<std::size_t Base>
+    static auto fold_chunk(char const *p, std::uint64_t &out) -> bool {
+#if defined(__SSE2__)
+        auto v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+
+        /* Candidate values for '0'..'9' and for 'a'..'f' / 'A'..'F', out-of-range bytes wrap to large values */
+        auto dec = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+        auto let = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+
+        auto is_dec = _mm_cmpeq_epi8(_mm_min_epu8(dec, _mm_set1_epi8(9)), dec);
+        auto is_let = _mm_andnot_si128(is_dec, _mm_cmpeq_epi8(_mm_min_epu8(let, _mm_set1_epi8(5)), let));
+        auto is_any = _mm_or_si128(is_dec, is_let);
+
+        auto digit = _mm_or_si128(
+                _mm_or_si128(_mm_and_si128(is_dec, dec),
+                             _mm_and_si128(is_let, _mm_add_epi8(let, _mm_set1_epi8(10)))),
+                _mm_andnot_si128(is_any, _mm_set1_epi8(static_cast<char>(0xFF))));
+
+        /* Every digit must be <= Base - 1 */
+        auto top = _mm_set1_epi8(static_cast<char>(Base - 1));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(digit, top), top)) != 0xFFFF) {
+            return false;
+        }
+
+        /* d0*B + d1 per pair, then p0*B^2 + p1 per pair of pairs: four groups of four digits each */
+        constexpr auto b1 = static_cast<short>(Base);
+        constexpr auto b2 = static_cast<short>(Base * Base);
+        auto zero = _mm_setzero_si128();
+        auto pairs = _mm_packs_epi32(
+                _mm_madd_epi16(_mm_unpacklo_epi8(digit, zero), _mm_set_epi16(1, b1, 1, b1, 1, b1, 1, b1)),
+                _mm_madd_epi16(_mm_unpackhi_epi8(digit, zero), _mm_set_epi16(1, b1, 1, b1, 1, b1, 1, b1)));
+        auto quads = _mm_madd_epi16(pairs, _mm_set_epi16(1, b2, 1, b2, 1, b2, 1, b2));
+
+        alignas(16) std::array<std::uint32_t, 4> group{};
+        _mm_store_si128(reinterpret_cast<__m128i *>(group.data()), quads);
+
+        /* Base^16 - 1 fits in 64 bits for every Base <= 16, so this cannot wrap */
+        constexpr std::uint64_t b4 = Base * Base * Base * Base;
+        out = ((group[0] * b4 + group[1]) * b4 + group[2]) * b4 + group[3];
+        return true;
+#else
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < chunk; ++i) {
+            auto d = digit_table[static_cast<unsigned char>(p[i])];
+            if (d >= Base) {
+                return false;
+            }
+            value = value * Base + d;
+        }
+        out = value;
+        return true;
+#endif
+    }
+
+    /// @brief Parse the unsigned magnitude of a digit string, failing once it exceeds limit
+    template<std::size_t Base>
+    static auto parse_magnitude(char const *p, std::size_t len, Magnitude limit)
+    -> std::pair<Magnitude, ParseStatus> {
+
+        constexpr auto base_pow_chunk = [] {
+            unsigned __int128 w = 1;
+            for (std::size_t i = 0; i < chunk; ++i) {
+                w *= Base;
+            }
+            return w;
+        }();
+
+        /* acc never exceeds limit < 2^64 before a multiply, so acc * Base^16 + value fits in 128 bits */
+        unsigned __int128 acc = 0;
+        bool overflow = false;
+
+        /* Leading partial chunk, left-padded with '0' so it can take the same vector path */
+        if (auto head = len % chunk; head != 0) {
+            std::array<char, chunk> padded{};
+            padded.fill('0');
+            std::memcpy(padded.data() + chunk - head, p, head);
+
+            std::uint64_t value = 0;
+            if (!fold_chunk<Base>(padded.data(), value)) {
+                return {0, ParseStatus::InvalidDigit};
+            }
+            acc = value;
+            overflow = acc > limit;
+            p += head;
+            len -= head;
+        }
+
+        /* Once overflowed keep validating, a malformed tail is reported as invalid rather than overflow */
+        for (; len != 0; p += chunk, len -= chunk) {
+            std::uint64_t value = 0;
+            if (!fold_chunk<Base>(p, value)) {
+                return {0, ParseStatus::InvalidDigit};
+            }
+            if (!overflow) {
+                acc = acc * base_pow_chunk + value;
+                overflow = acc > limit;
+            }
+        }
+
+        if (overflow) {
+            return {0, ParseStatus::Overflow};
+        }
+        return {static_cast<Magnitude>(acc), ParseStatus::Ok};
+    }
+
+    /// One parser instantiation per radix, indexed by radix
+    static constexpr auto parsers = []<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array<Parser, sizeof...(I)>{
+                (I < min_radix ? nullptr : &RadixParse::parse_magnitude<(I < min_radix ? min_radix : I)>)...};
+    }(std::make_index_sequence<max_radix + 1>{});
+
+    static auto parser_for(std::size_t radix) -> Parser {
+        if (radix < min_radix || radix > max_radix) {
+            throw std::invalid_argument("RadixParse radix must be between 2 and 16");
+        }
+        return parsers[radix];
+    }
+
+    static auto parse_with(Parser parser, std::string_view text, T &value) -> ParseStatus {
+        if (text.empty()) {
+            return ParseStatus::Empty;
+        }
+
+        bool negative = false;
+        if constexpr (std::is_signed_v<T>) {
+            if (text.front() == '-') {
+                negative = true;
+                text.remove_prefix(1);
+                if (text.empty()) {
+                    return ParseStatus::InvalidDigit;
+                }
+            }
+        }
+
+        /* A negative value may reach one past max in magnitude */
+        auto limit = static_cast<Magnitude>(std::numeric_limits<T>::max()) + static_cast<Magnitude>(negative);
+
+        auto [magnitude, status] = parser(text.data(), text.size(), limit);
+        if (status == ParseStatus::Ok) {
+            value = negative ? static_cast<T>(Magnitude{0} - magnitude) : static_cast<T>(magnitude);
+        }
+        return status;
+    }
+
+public: /* Public Methods */
+
+    /// @brief Parse a single digit string in the given radix
+    /// @param value left unchanged unless the result is ParseStatus::Ok
+    static auto operator()(std::string_view text, std::size_t radix, T &value) -> ParseStatus {
+        return parse_with(parser_for(radix), text, value);
+    }
+
+    /// @brief Parse every line of a newline-delimited buffer ("\r\n" is accepted as well)
+    ///
+    /// One entry is appended to values and status per line; a trailing newline does not start a new line.
+    /// @return the number of lines that did not parse
+    static auto batch(std::string_view buffer, std::size_t radix,
+                      std::vector<T> &values, std::vector<ParseStatus> &status) -> std::size_t {
+        Instrumentation::ScopedTimer timer(Instrumentation::Timer::RadixParse);
+
+        auto parser = parser_for(radix);
+        std::size_t failures = 0;
+
+        while (!buffer.empty()) {
+            auto eol = buffer.find('\n');
+            auto line = buffer.substr(0, eol);
+            buffer.remove_prefix(eol == std::string_view::npos ? buffer.size() : eol + 1);
+
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+
+            T value{};
+            auto s = parse_with(parser, line, value);
+            values.push_back(value);
+            status.push_back(s);
+            failures += s != ParseStatus::Ok;
+        }
+
+        return failures;
+    }
+};
+
+
+#endif
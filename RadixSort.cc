@@ -0,0 +1 @@
+#include "RadixSort.tcc"
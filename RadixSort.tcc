@@ -0,0 +1,440 @@
+#ifndef THREADED_RADIX_SORT_TCC
+#define THREADED_RADIX_SORT_TCC
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ArithmeticRadix.tcc"
+#include "Instrumentation.tcc"
+
+
+/* Concept for a key type the radix sort knows how to order */
+template<typename K>
+concept RadixSortableKey = std::integral<K> || std::same_as<K, float> || std::same_as<K, double>;
+
+
+/// @brief Parallel, stable LSD/MSD radix sort over integral and IEEE-754 keys.
+///
+/// Every pass runs a per-thread histogram over a contiguous chunk of the input, a prefix sum over
+/// (digit, thread) to give each thread a private, stable output window per bucket, and a scatter that
+/// stages elements in software write-combining buffers so each bucket is written one cache line at a
+/// time instead of one element at a time.
+template<RadixSortableKey Key, typename Radix = ArithmeticRadix<256>>
+class RadixSort {
+
+private: /* Private types */
+
+    /// Unsigned integer with the same width as Key; all passes run on these order-preserving bits
+    using Bits = std::conditional_t<sizeof(Key) <= 4, std::uint32_t, std::uint64_t>;
+
+    static_assert(sizeof(Key) <= sizeof(Bits), "RadixSort keys must be at most 64 bits wide");
+    static_assert(Radix::base <= (1 << 16), "RadixSort histograms are sized by the base, keep it at most 2^16");
+
+    /// Placeholder payload for the key-only sort
+    struct NoPayload {
+    };
+
+    using Histogram = std::array<std::size_t, Radix::base>;
+
+private: /* Private Members */
+
+    /// Number of digit passes required to cover every bit of Key
+    static constexpr std::size_t passes = Radix::template digits<Bits>();
+
+    /// Bytes staged per bucket before flushing to the destination
+    static constexpr std::size_t wc_line_bytes = 64;
+
+    /// Write-combining is skipped for large bases, the staging area would no longer fit in L1/L2
+    static constexpr bool use_write_combining = Radix::base <= 4096;
+
+    /// Below this many keys per thread the pass is not worth splitting
+    static constexpr std::size_t min_keys_per_thread = 1 << 16;
+
+    static constexpr Bits sign_bit = Bits{1} << (sizeof(Key) * 8 - 1);
+
+private: /* Private Methods */
+
+    /// @brief Map a key onto unsigned bits whose unsigned order equals the key order
+    static constexpr auto to_bits(Key key) -> Bits {
+        if constexpr (std::is_floating_point_v<Key>) {
+            using Raw = std::conditional_t<sizeof(Key) == 4, std::uint32_t, std::uint64_t>;
+            auto bits = static_cast<Bits>(std::bit_cast<Raw>(key));
+            return (bits & sign_bit) ? static_cast<Bits>(~bits) : static_cast<Bits>(bits | sign_bit);
+        } else if constexpr (std::is_signed_v<Key>) {
+            return static_cast<Bits>(static_cast<std::make_unsigned_t<Key>>(key)) ^ sign_bit;
+        } else {
+            return static_cast<Bits>(key);
+        }
+    }
+
+    /// @brief Inverse of to_bits
+    static constexpr auto from_bits(Bits bits) -> Key {
+        if constexpr (std::is_floating_point_v<Key>) {
+            using Raw = std::conditional_t<sizeof(Key) == 4, std::uint32_t, std::uint64_t>;
+            bits = (bits & sign_bit) ? static_cast<Bits>(bits ^ sign_bit) : static_cast<Bits>(~bits);
+            return std::bit_cast<Key>(static_cast<Raw>(bits));
+        } else if constexpr (std::is_signed_v<Key>) {
+            return static_cast<Key>(static_cast<std::make_unsigned_t<Key>>(bits ^ sign_bit));
+        } else {
+            return static_cast<Key>(bits);
+        }
+    }
+
+    static auto thread_count(std::size_t n, std::size_t requested) -> std::size_t {
+        auto hw = requested ? requested : std::max<std::size_t>(1, std::thread::hardware_concurrency());
+        return std::clamp<std::size_t>(n / min_keys_per_thread, 1, hw);
+    }
+
+    static auto histogram(Bits const *src, std::size_t begin, std::size_t end, std::size_t pass, Histogram &hist)
+    -> void {
+        hist.fill(0);
+        for (auto i = begin; i < end; ++i) {
+            ++hist[Radix::digit(src[i], pass)];
+        }
+    }
+
+    /// @brief Stable scatter of [begin, end) into dst using the precomputed per-bucket write cursors
+    template<typename P>
+    static auto scatter(Bits const *src_k, Bits *dst_k, P const *src_p, P *dst_p,
+                        std::size_t begin, std::size_t end, std::size_t pass, Histogram &cursor) -> void {
+
+        constexpr bool has_payload = !std::is_same_v<P, NoPayload>;
+
+        if constexpr (!use_write_combining) {
+            for (auto i = begin; i < end; ++i) {
+                auto d = Radix::digit(src_k[i], pass);
+                if constexpr (has_payload) {
+                    dst_p[cursor[d]] = src_p[i];
+                }
+                dst_k[cursor[d]++] = src_k[i];
+            }
+        } else {
+            /* Stage a cache line worth of keys per bucket, then flush it as one block */
+            constexpr std::size_t lane = std::max<std::size_t>(1, wc_line_bytes / sizeof(Bits));
+
+            struct alignas(64) Staging {
+                std::array<std::array<Bits, lane>, Radix::base> keys;
+                std::array<std::array<std::conditional_t<has_payload, P, char>, has_payload ? lane : 1>,
+                        Radix::base> payload;
+                std::array<std::uint16_t, Radix::base> fill;
+            };
+
+            auto staging = std::make_unique<Staging>();
+            staging->fill.fill(0);
+
+            for (auto i = begin; i < end; ++i) {
+                auto d = Radix::digit(src_k[i], pass);
+                auto f = staging->fill[d];
+                staging->keys[d][f] = src_k[i];
+                if constexpr (has_payload) {
+                    staging->payload[d][f] = src_p[i];
+                }
+                if (++f == lane) {
+                    std::memcpy(dst_k + cursor[d], staging->keys[d].data(), lane * sizeof(Bits));
+                    if constexpr (has_payload) {
+                        std::copy_n(staging->payload[d].data(), lane, dst_p + cursor[d]);
+                    }
+                    cursor[d] += lane;
+                    f = 0;
+                }
+                staging->fill[d] = f;
+            }
+
+            /* Flush whatever is left in every bucket */
+            for (std::size_t d = 0; d < Radix::base; ++d) {
+                auto f = staging->fill[d];
+                std::memcpy(dst_k + cursor[d], staging->keys[d].data(), f * sizeof(Bits));
+                if constexpr (has_payload) {
+                    std::copy_n(staging->payload[d].data(), f, dst_p + cursor[d]);
+                }
+                cursor[d] += f;
+            }
+        }
+    }
+
+    /// @brief Sequential LSD over the digit positions [0, last_pass); result ends up back in keys
+    template<typename P>
+    static auto sort_range(Bits *keys, Bits *scratch_k, P *payload, P *scratch_p, std::size_t n,
+                           std::size_t last_pass) -> void {
+        if (n < 2) {
+            return;
+        }
+
+        Bits *src_k = keys, *dst_k = scratch_k;
+        P *src_p = payload, *dst_p = scratch_p;
+        Histogram hist{};
+
+        for (std::size_t pass = 0; pass < last_pass; ++pass) {
+            histogram(src_k, 0, n, pass, hist);
+            if (std::ranges::find(hist, n) != hist.end()) {
+                continue;
+            }
+            std::exclusive_scan(hist.begin(), hist.end(), hist.begin(), std::size_t{0});
+            scatter(src_k, dst_k, src_p, dst_p, 0, n, pass, hist);
+            std::swap(src_k, dst_k);
+            std::swap(src_p, dst_p);
+        }
+
+        if (src_k != keys) {
+            std::copy_n(src_k, n, keys);
+            if constexpr (!std::is_same_v<P, NoPayload>) {
+                std::copy_n(src_p, n, payload);
+            }
+        }
+    }
+
+    /// @brief Parallel LSD over digit positions [first_pass, last_pass) with buffer ping-pong.
+    /// @return true if the sorted data ended up in the scratch buffers rather than the input buffers
+    template<typename P>
+    static auto parallel_passes(Bits *keys, Bits *scratch_k, P *payload, P *scratch_p, std::size_t n,
+                                std::size_t first_pass, std::size_t last_pass, std::size_t threads) -> bool {
+
+        std::vector<Histogram> hist(threads);
+        std::barrier sync(static_cast<std::ptrdiff_t>(threads));
+        bool swapped = false;
+
+        auto worker = [&](std::size_t t) {
+            auto begin = n * t / threads;
+            auto end = n * (t + 1) / threads;
+
+            Bits *src_k = keys, *dst_k = scratch_k;
+            P *src_p = payload, *dst_p = scratch_p;
+
+            for (auto pass = first_pass; pass < last_pass; ++pass) {
+                histogram(src_k, begin, end, pass, hist[t]);
+                sync.arrive_and_wait();
+
+                /* Every thread derives the same totals, so they all agree on skipping a trivial pass */
+                Histogram cursor{};
+                std::size_t running = 0;
+                bool trivial = false;
+                for (std::size_t d = 0; d < Radix::base; ++d) {
+                    std::size_t total = 0;
+                    for (std::size_t u = 0; u < threads; ++u) {
+                        if (u == t) {
+                            cursor[d] = running + total;
+                        }
+                        total += hist[u][d];
+                    }
+                    trivial = trivial || total == n;
+                    running += total;
+                }
+
+                if (!trivial) {
+                    scatter(src_k, dst_k, src_p, dst_p, begin, end, pass, cursor);
+                    std::swap(src_k, dst_k);
+                    std::swap(src_p, dst_p);
+                }
+                sync.arrive_and_wait();
+            }
+
+            if (t == 0) {
+                swapped = src_k != keys;
+            }
+        };
+
+        std::vector<std::jthread> pool;
+        pool.reserve(threads - 1);
+        for (std::size_t t = 1; t < threads; ++t) {
+            pool.emplace_back(worker, t);
+        }
+        worker(0);
+        pool.clear();
+
+        return swapped;
+    }
+
+    /// @brief Most significant digit position on which the keys differ, passes if they are all equal.
+    ///
+    /// Every key lies between the smallest and the largest, so the digits above the first one where those two
+    /// differ are the same in every key.
+    static auto leading_pass(Bits const *keys, std::size_t n, std::size_t threads) -> std::size_t {
+        std::vector<std::pair<Bits, Bits>> ranges(threads);
+        {
+            auto scan = [&](std::size_t t) {
+                auto [lo, hi] = std::minmax_element(keys + n * t / threads, keys + n * (t + 1) / threads);
+                ranges[t] = {*lo, *hi};
+            };
+            std::vector<std::jthread> pool;
+            for (std::size_t t = 1; t < threads; ++t) {
+                pool.emplace_back(scan, t);
+            }
+            scan(0);
+        }
+        auto lo = std::ranges::min(ranges, {}, &std::pair<Bits, Bits>::first).first;
+        auto hi = std::ranges::max(ranges, {}, &std::pair<Bits, Bits>::second).second;
+        for (auto pass = passes; pass-- > 0;) {
+            if (Radix::digit(lo, pass) != Radix::digit(hi, pass)) {
+                return pass;
+            }
+        }
+        return passes;
+    }
+
+    template<typename P>
+    static auto sort(std::span<Key> keys, P *payload, std::size_t requested_threads, bool msd) -> void {
+        Instrumentation::ScopedTimer timer(Instrumentation::Timer::RadixSort);
+
+        auto n = keys.size();
+        if (n < 2) {
+            return;
+        }
+
+        auto threads = thread_count(n, requested_threads);
+
+        /* Unsigned keys already are their own order-preserving bits and are sorted in place */
+        constexpr bool in_place = std::is_same_v<Key, Bits>;
+
+        std::vector<Bits> a_storage(in_place ? 0 : n), b(n);
+        std::vector<P> scratch_payload(std::is_same_v<P, NoPayload> ? 0 : n);
+        auto *scratch_p = scratch_payload.data();
+
+        auto convert = [&](auto &&fn) {
+            std::vector<std::jthread> pool;
+            for (std::size_t t = 1; t < threads; ++t) {
+                pool.emplace_back(fn, n * t / threads, n * (t + 1) / threads);
+            }
+            fn(0, n / threads);
+        };
+
+        Bits *a = nullptr;
+        if constexpr (in_place) {
+            a = keys.data();
+        } else {
+            a = a_storage.data();
+            convert([&](std::size_t begin, std::size_t end) {
+                std::transform(keys.begin() + begin, keys.begin() + end, a + begin, to_bits);
+            });
+        }
+
+        Bits *result = a;
+        P *result_p = payload;
+
+        if (!msd) {
+            if (parallel_passes(a, b.data(), payload, scratch_p, n, 0, passes, threads)) {
+                result = b.data();
+                result_p = scratch_p;
+            }
+        } else if (auto lead = leading_pass(a, n, threads); lead < passes) {
+            /* MSD: one parallel pass on the most significant digit the keys differ in (every digit above it is
+               shared, so bucketing on it already orders the buckets), then the buckets are finished on the
+               digits below it */
+            if (parallel_passes(a, b.data(), payload, scratch_p, n, lead, lead + 1, threads)) {
+                result = b.data();
+                result_p = scratch_p;
+            }
+            Bits *other = result == a ? b.data() : a;
+            P *other_p = result_p == payload ? scratch_p : payload;
+
+            Histogram bounds{};
+            for (std::size_t i = 0; i < n; ++i) {
+                ++bounds[Radix::digit(result[i], lead)];
+            }
+            std::exclusive_scan(bounds.begin(), bounds.end(), bounds.begin(), std::size_t{0});
+
+            auto bucket = [&](std::size_t d) {
+                auto begin = bounds[d];
+                auto end = d + 1 < Radix::base ? bounds[d + 1] : n;
+                P *range_p = nullptr, *other_range_p = nullptr;
+                if constexpr (!std::is_same_v<P, NoPayload>) {
+                    range_p = result_p + begin;
+                    other_range_p = other_p + begin;
+                }
+                return std::tuple(begin, end - begin, range_p, other_range_p);
+            };
+
+            /* A bucket holding more than one thread's share (skewed keys) gets every thread, the rest one each */
+            auto dominant = [&](std::size_t length) { return threads > 1 && length > n / threads; };
+            for (std::size_t d = 0; d < Radix::base; ++d) {
+                auto [begin, length, range_p, other_range_p] = bucket(d);
+                if (!dominant(length)) {
+                    continue;
+                }
+                if (parallel_passes(result + begin, other + begin, range_p, other_range_p, length, 0, lead,
+                                    thread_count(length, threads))) {
+                    std::copy_n(other + begin, length, result + begin);
+                    if constexpr (!std::is_same_v<P, NoPayload>) {
+                        std::copy_n(other_range_p, length, range_p);
+                    }
+                }
+            }
+
+            std::atomic<std::size_t> next{0};
+            auto worker = [&] {
+                for (auto d = next++; d < Radix::base; d = next++) {
+                    auto [begin, length, range_p, other_range_p] = bucket(d);
+                    if (!dominant(length)) {
+                        sort_range(result + begin, other + begin, range_p, other_range_p, length, lead);
+                    }
+                }
+            };
+            std::vector<std::jthread> pool;
+            for (std::size_t t = 1; t < threads; ++t) {
+                pool.emplace_back(worker);
+            }
+            worker();
+        }
+
+        if constexpr (!std::is_same_v<P, NoPayload>) {
+            if (result_p != payload) {
+                std::copy_n(result_p, n, payload);
+            }
+        }
+
+        if constexpr (in_place) {
+            if (result != a) {
+                convert([&](std::size_t begin, std::size_t end) {
+                    std::copy(result + begin, result + end, a + begin);
+                });
+            }
+        } else {
+            convert([&](std::size_t begin, std::size_t end) {
+                std::transform(result + begin, result + end, keys.begin() + begin, from_bits);
+            });
+        }
+    }
+
+public: /* Public Methods */
+
+    /// @brief Stable parallel LSD sort of keys
+    /// @param threads worker count, 0 picks one per hardware thread
+    static auto operator()(std::span<Key> keys, std::size_t threads = 0) -> void {
+        sort<NoPayload>(keys, nullptr, threads, false);
+    }
+
+    /// @brief Stable parallel LSD sort of keys, permuting payload alongside
+    template<typename Payload>
+    static auto operator()(std::span<Key> keys, std::span<Payload> payload, std::size_t threads = 0) -> void {
+        sort<Payload>(keys, payload.data(), threads, false);
+    }
+
+    /// @brief Parallel MSD sort: scatter on the leading digit the keys differ in, then sort each bucket on its
+    /// own thread (buckets bigger than one thread's share are sorted by all of them)
+    static auto msd(std::span<Key> keys, std::size_t threads = 0) -> void {
+        sort<NoPayload>(keys, nullptr, threads, true);
+    }
+
+    /// @brief Parallel MSD sort permuting payload alongside keys
+    template<typename Payload>
+    static auto msd(std::span<Key> keys, std::span<Payload> payload, std::size_t threads = 0) -> void {
+        sort<Payload>(keys, payload.data(), threads, true);
+    }
+};
+
+
+#endif
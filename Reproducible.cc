@@ -0,0 +1 @@
+#include "Reproducible.tcc"
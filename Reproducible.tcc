@@ -0,0 +1,142 @@
+#ifndef THREADED_REPRODUCIBLE_TCC
+#define THREADED_REPRODUCIBLE_TCC
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "NPlus.tcc"
+#include "ThreadPool.tcc"
+
+
+/// Bitwise reproducibility of parallel floating point results across thread counts.
+///
+/// In Fast mode parallel passes split their input by the number of threads available, so the association
+/// order of a floating point reduction (and with it the rounding) follows the machine. In Deterministic mode
+/// the split is a function of the element count alone and partial results are combined by a fixed tree keyed
+/// by element index, so 8 and 64 cores produce identical bits; threads only decide who computes which node.
+namespace Reproducible {
+
+    enum class Mode : std::uint8_t {
+        Fast = 0,
+        Deterministic = 1,
+    };
+
+    namespace detail {
+
+        /// Elements per leaf of the deterministic reduction tree
+        inline constexpr std::size_t leaf = 1024;
+
+        /// Chunk count used by deterministic chunked passes once the input is large enough
+        inline constexpr std::size_t fixed_chunks = 64;
+
+        /// Independent accumulators inside a leaf, combined pairwise
+        inline constexpr std::size_t lanes = 8;
+
+        inline auto initial_mode() -> Mode {
+            auto const *env = std::getenv("THREADED_REPRODUCIBLE");
+            return env && std::string_view(env) != "0" ? Mode::Deterministic : Mode::Fast;
+        }
+
+        inline auto mode_storage() -> std::atomic<Mode> & {
+            static std::atomic<Mode> mode{initial_mode()};
+            return mode;
+        }
+
+        /// @brief Fixed-shape sum of one leaf: lane i takes every lanes-th element, lanes are added pairwise
+        template<typename T>
+        auto leaf_sum(T const *in, std::size_t n) -> T {
+            using Add = NPlus<T, OverflowPolicy::Wrap>;
+            std::array<T, lanes> acc{};
+            std::size_t i = 0;
+            for (; i + lanes <= n; i += lanes) {
+                for (std::size_t l = 0; l < lanes; ++l) {
+                    acc[l] = Add::wrapping_add(acc[l], in[i + l]);
+                }
+            }
+            for (std::size_t l = 0; i < n; ++i, ++l) {
+                acc[l] = Add::wrapping_add(acc[l], in[i]);
+            }
+            for (std::size_t width = lanes / 2; width > 0; width /= 2) {
+                for (std::size_t l = 0; l < width; ++l) {
+                    acc[l] = Add::wrapping_add(acc[2 * l], acc[2 * l + 1]);
+                }
+            }
+            return acc[0];
+        }
+
+        /// @brief Pairwise tree over partials: at each level neighbours (2k, 2k + 1) are added in index order
+        template<typename T>
+        auto tree_sum(std::vector<T> partials) -> T {
+            using Add = NPlus<T, OverflowPolicy::Wrap>;
+            if (partials.empty()) {
+                return T{};
+            }
+            for (auto width = partials.size(); width > 1; width = (width + 1) / 2) {
+                for (std::size_t k = 0; k < width / 2; ++k) {
+                    partials[k] = Add::wrapping_add(partials[2 * k], partials[2 * k + 1]);
+                }
+                if (width % 2) {
+                    partials[width / 2] = partials[width - 1];
+                }
+            }
+            return partials[0];
+        }
+
+    }
+
+    /// @brief Process-wide default; starts as Deterministic when THREADED_REPRODUCIBLE is set to anything but 0
+    inline auto mode() -> Mode { return detail::mode_storage().load(std::memory_order_relaxed); }
+
+    inline auto set_mode(Mode mode) -> void { detail::mode_storage().store(mode, std::memory_order_relaxed); }
+
+    /// @brief Number of chunks a parallel pass over n elements should use
+    /// @param min_chunk smallest chunk worth handing to a thread
+    inline auto chunk_count(std::size_t n, std::size_t min_chunk, ThreadPool &pool, Mode mode) -> std::size_t {
+        auto limit = mode == Mode::Deterministic ? detail::fixed_chunks : pool.concurrency() * 4;
+        return std::clamp<std::size_t>(n / std::max<std::size_t>(min_chunk, 1), 1, limit);
+    }
+
+    /// @brief Parallel sum of in, wrapping on integer overflow.
+    ///
+    /// In Deterministic mode the result depends only on the values and their order, never on the pool size.
+    template<typename T> requires std::is_arithmetic_v<T>
+    auto sum(std::span<T const> in, Mode mode = Reproducible::mode(), ThreadPool &pool = ThreadPool::shared()) -> T {
+        auto n = in.size();
+
+        if (mode == Mode::Deterministic) {
+            auto leaves = (n + detail::leaf - 1) / detail::leaf;
+            std::vector<T> partials(leaves);
+            auto groups = chunk_count(leaves, 16, pool, Mode::Fast);
+            pool.for_each_index(groups, [&](std::size_t g) {
+                for (auto l = leaves * g / groups; l < leaves * (g + 1) / groups; ++l) {
+                    auto begin = l * detail::leaf;
+                    partials[l] = detail::leaf_sum(in.data() + begin, std::min(detail::leaf, n - begin));
+                }
+            });
+            return detail::tree_sum(std::move(partials));
+        }
+
+        auto chunks = chunk_count(n, detail::leaf * 16, pool, Mode::Fast);
+        std::vector<T> partials(chunks);
+        pool.for_each_index(chunks, [&](std::size_t c) {
+            auto begin = n * c / chunks;
+            partials[c] = detail::leaf_sum(in.data() + begin, n * (c + 1) / chunks - begin);
+        });
+        T total{};
+        for (auto p: partials) {
+            total = NPlus<T, OverflowPolicy::Wrap>::wrapping_add(total, p);
+        }
+        return total;
+    }
+}
+
+
+#endif
@@ -0,0 +1 @@
+#include "ResultMask.tcc"
@@ -0,0 +1,483 @@
+#ifndef THREADED_RESULT_MASK_TCC
+#define THREADED_RESULT_MASK_TCC
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+
+/// @brief Bit-packed per-element result of a check pass (overflow, underflow, ...), one bit per element.
+///
+/// Bits past size() in the last word are always zero, so whole-word operations never need a tail case
+/// except where all() compares against ones.
+class ResultMask {
+
+public: /* Public types */
+
+    /// @brief Forward iterator over the indices of set bits, one countr_zero (tzcnt) per set bit
+    class SetBitIterator {
+        std::uint64_t const *m_words = nullptr;
+        std::size_t m_word = 0;
+        std::size_t m_words_count = 0;
+        std::uint64_t m_bits = 0;
+
+        auto skip_empty() noexcept -> void {
+            while (m_bits == 0 && ++m_word < m_words_count) {
+                m_bits = m_words[m_word];
+            }
+        }
+
+    public:
+        using iterator_concept = std::forward_iterator_tag;
+        using value_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        SetBitIterator() noexcept = default;
+
+        SetBitIterator(std::span<std::uint64_t const> words) noexcept
+                : m_words(words.data()), m_words_count(words.size()), m_bits(words.empty() ? 0 : words[0]) {
+            skip_empty();
+        }
+
+        auto operator*() const noexcept -> std::size_t {
+            return m_word * 64 + static_cast<std::size_t>(std::countr_zero(m_bits));
+        }
+
+        auto operator++() noexcept -> SetBitIterator & {
+            m_bits &= m_bits - 1;
+            skip_empty();
+            return *this;
+        }
+
+        auto operator++(int) noexcept -> SetBitIterator {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        friend auto operator==(SetBitIterator const &it, std::default_sentinel_t) noexcept -> bool {
+            return it.m_bits == 0;
+        }
+
+        friend auto operator==(SetBitIterator const &lhs, SetBitIterator const &rhs) noexcept -> bool {
+            return lhs.m_word == rhs.m_word && lhs.m_bits == rhs.m_bits;
+        }
+    };
+
+private: /* Private Members */
+
+    std::vector<std::uint64_t> m_words{};
+    std::size_t m_size = 0;
+
+private: /* Private Methods */
+
+    /// @brief Valid bits of the last word
+    auto tail_mask() const noexcept -> std::uint64_t {
+        return m_size % 64 ? (std::uint64_t{1} << (m_size % 64)) - 1 : ~std::uint64_t{0};
+    }
+
+    auto check_size(ResultMask const &other) const -> void {
+        if (other.m_size != m_size) {
+            throw std::invalid_argument("ResultMask: masks of different sizes");
+        }
+    }
+
+public: /* Constructors */
+
+    ResultMask() = default;
+
+    explicit ResultMask(std::size_t size, bool value = false)
+            : m_words((size + 63) / 64, value ? ~std::uint64_t{0} : 0), m_size(size) {
+        if (value && !m_words.empty()) {
+            m_words.back() &= tail_mask();
+        }
+    }
+
+    explicit ResultMask(std::vector<bool> const &bits) : ResultMask(bits.size()) {
+        for (std::size_t i = 0; i < bits.size(); ++i) {
+            m_words[i / 64] |= std::uint64_t{bits[i]} << (i % 64);
+        }
+    }
+
+    /// @brief Set wherever flags is non-zero, as produced by the span-based kernels
+    static auto from_flags(std::span<std::uint8_t const> flags) -> ResultMask {
+        ResultMask mask(flags.size());
+        for (std::size_t w = 0; w < mask.m_words.size(); ++w) {
+            std::uint64_t word = 0;
+            auto base = w * 64;
+            auto bits = std::min<std::size_t>(64, flags.size() - base);
+            for (std::size_t b = 0; b < bits; ++b) {
+                word |= std::uint64_t{flags[base + b] != 0} << b;
+            }
+            mask.m_words[w] = word;
+        }
+        return mask;
+    }
+
+public: /* Public Methods */
+
+    auto size() const noexcept -> std::size_t { return m_size; }
+
+    /// @brief The packed words, bit i of word w being element 64 w + i; writers must keep tail bits zero
+    auto words() noexcept -> std::span<std::uint64_t> { return m_words; }
+
+    auto words() const noexcept -> std::span<std::uint64_t const> { return m_words; }
+
+    auto test(std::size_t i) const noexcept -> bool { return (m_words[i / 64] >> (i % 64)) & 1; }
+
+    auto set(std::size_t i, bool value = true) noexcept -> void {
+        auto bit = std::uint64_t{1} << (i % 64);
+        m_words[i / 64] = value ? m_words[i / 64] | bit : m_words[i / 64] & ~bit;
+    }
+
+    auto count() const noexcept -> std::size_t {
+        std::size_t total = 0;
+        for (auto word: m_words) {
+            total += static_cast<std::size_t>(std::popcount(word));
+        }
+        return total;
+    }
+
+    /// @brief Stops at the first non-zero word
+    auto any() const noexcept -> bool {
+        return std::ranges::any_of(m_words, [](std::uint64_t word) { return word != 0; });
+    }
+
+    auto none() const noexcept -> bool { return !any(); }
+
+    /// @brief Stops at the first word with a clear bit
+    auto all() const noexcept -> bool {
+        if (m_words.empty()) {
+            return true;
+        }
+        auto full = std::all_of(m_words.begin(), m_words.end() - 1, [](std::uint64_t word) { return !~word; });
+        return full && m_words.back() == tail_mask();
+    }
+
+    /// @brief Indices of the set bits, ascending
+    auto ones() const noexcept -> std::ranges::subrange<SetBitIterator, std::default_sentinel_t> {
+        return {SetBitIterator(m_words), std::default_sentinel};
+    }
+
+    auto indices() const -> std::vector<std::size_t> {
+        std::vector<std::size_t> result;
+        result.reserve(count());
+        for (auto i: ones()) {
+            result.push_back(i);
+        }
+        return result;
+    }
+
+    auto operator&=(ResultMask const &other) -> ResultMask & {
+        check_size(other);
+        for (std::size_t w = 0; w < m_words.size(); ++w) {
+            m_words[w] &= other.m_words[w];
+        }
+        return *this;
+    }
+
+    auto operator|=(ResultMask const &other) -> ResultMask & {
+        check_size(other);
+        for (std::size_t w = 0; w < m_words.size(); ++w) {
+            m_words[w] |= other.m_words[w];
+        }
+        return *this;
+    }
+
+    friend auto operator&(ResultMask lhs, ResultMask const &rhs) -> ResultMask { return lhs &= rhs; }
+
+    friend auto operator|(ResultMask lhs, ResultMask const &rhs) -> ResultMask { return lhs |= rhs; }
+
+    auto operator~() const -> ResultMask {
+        auto result = *this;
+        for (auto &word: result.m_words) {
+            word = ~word;
+        }
+        if (!result.m_words.empty()) {
+            result.m_words.back() &= tail_mask();
+        }
+        return result;
+    }
+
+    friend auto operator==(ResultMask const &, ResultMask const &) -> bool = default;
+};
+
+
+/// @brief Roaring-style compressed ResultMask for sparse results.
+///
+/// The index space is cut into chunks of 2^16 elements and only non-empty chunks are stored: as a sorted
+/// array of 16-bit offsets while they hold at most 4096 set bits (2 bytes per bit), as a 1024-word bitmap
+/// beyond that (8 KiB, whatever the count). AND and OR work chunk by chunk on these containers directly.
+class CompressedMask {
+
+private: /* Private types */
+
+    static constexpr std::size_t chunk_bits = 1 << 16;
+    static constexpr std::size_t chunk_words = chunk_bits / 64;
+    static constexpr std::size_t array_limit = 4096;
+
+    struct Container {
+        std::size_t key = 0;
+        std::vector<std::uint16_t> array{};
+        std::vector<std::uint64_t> bitmap{};  ///< empty while in array form
+        std::size_t cardinality = 0;
+
+        auto is_bitmap() const noexcept -> bool { return !bitmap.empty(); }
+
+        /// @brief Positions of the set bits of a chunk's words, ascending
+        static auto offsets(std::span<std::uint64_t const> words, std::size_t cardinality)
+        -> std::vector<std::uint16_t> {
+            std::vector<std::uint16_t> result;
+            result.reserve(cardinality);
+            for (auto it = ResultMask::SetBitIterator(words); it != std::default_sentinel; ++it) {
+                result.push_back(static_cast<std::uint16_t>(*it));
+            }
+            return result;
+        }
+
+        auto contains(std::uint16_t low) const noexcept -> bool {
+            return is_bitmap() ? (bitmap[low / 64] >> (low % 64)) & 1 : std::ranges::binary_search(array, low);
+        }
+
+        /// @brief Re-pick the form from the cardinality
+        auto normalize() -> void {
+            if (is_bitmap() && cardinality <= array_limit) {
+                array = offsets(bitmap, cardinality);
+                bitmap.clear();
+            } else if (!is_bitmap() && cardinality > array_limit) {
+                bitmap.assign(chunk_words, 0);
+                for (auto low: array) {
+                    bitmap[low / 64] |= std::uint64_t{1} << (low % 64);
+                }
+                array.clear();
+            }
+        }
+
+        template<typename F>
+        auto for_each(F &&fn) const -> void {
+            auto base = key * chunk_bits;
+            if (is_bitmap()) {
+                for (std::size_t w = 0; w < chunk_words; ++w) {
+                    for (auto word = bitmap[w]; word; word &= word - 1) {
+                        fn(base + w * 64 + static_cast<std::size_t>(std::countr_zero(word)));
+                    }
+                }
+            } else {
+                for (auto low: array) {
+                    fn(base + low);
+                }
+            }
+        }
+
+        auto to_bitmap() const -> std::vector<std::uint64_t> {
+            if (is_bitmap()) {
+                return bitmap;
+            }
+            std::vector<std::uint64_t> words(chunk_words, 0);
+            for (auto low: array) {
+                words[low / 64] |= std::uint64_t{1} << (low % 64);
+            }
+            return words;
+        }
+
+        static auto from_bitmap(std::size_t key, std::vector<std::uint64_t> words) -> Container {
+            Container c{key, {}, std::move(words), 0};
+            for (auto word: c.bitmap) {
+                c.cardinality += static_cast<std::size_t>(std::popcount(word));
+            }
+            c.normalize();
+            return c;
+        }
+
+        static auto intersect(Container const &a, Container const &b) -> Container {
+            if (a.is_bitmap() && b.is_bitmap()) {
+                auto words = a.bitmap;
+                for (std::size_t w = 0; w < chunk_words; ++w) {
+                    words[w] &= b.bitmap[w];
+                }
+                return from_bitmap(a.key, std::move(words));
+            }
+            Container c{a.key};
+            if (!a.is_bitmap() && !b.is_bitmap()) {
+                std::ranges::set_intersection(a.array, b.array, std::back_inserter(c.array));
+            } else {
+                auto const &sparse = a.is_bitmap() ? b : a;
+                auto const &dense = a.is_bitmap() ? a : b;
+                std::ranges::copy_if(sparse.array, std::back_inserter(c.array),
+                                     [&](std::uint16_t low) { return dense.contains(low); });
+            }
+            c.cardinality = c.array.size();
+            return c;
+        }
+
+        static auto unite(Container const &a, Container const &b) -> Container {
+            if (!a.is_bitmap() && !b.is_bitmap() && a.cardinality + b.cardinality <= array_limit) {
+                Container c{a.key};
+                std::ranges::set_union(a.array, b.array, std::back_inserter(c.array));
+                c.cardinality = c.array.size();
+                return c;
+            }
+            auto words = a.to_bitmap();
+            if (b.is_bitmap()) {
+                for (std::size_t w = 0; w < chunk_words; ++w) {
+                    words[w] |= b.bitmap[w];
+                }
+            } else {
+                for (auto low: b.array) {
+                    words[low / 64] |= std::uint64_t{1} << (low % 64);
+                }
+            }
+            return from_bitmap(a.key, std::move(words));
+        }
+    };
+
+private: /* Private Members */
+
+    std::vector<Container> m_containers{};  ///< non-empty only, ascending key
+    std::size_t m_size = 0;
+
+private: /* Private Methods */
+
+    auto check_size(CompressedMask const &other) const -> void {
+        if (other.m_size != m_size) {
+            throw std::invalid_argument("CompressedMask: masks of different sizes");
+        }
+    }
+
+public: /* Constructors */
+
+    CompressedMask() = default;
+
+    explicit CompressedMask(std::size_t size) : m_size(size) {}
+
+    explicit CompressedMask(ResultMask const &mask) : m_size(mask.size()) {
+        auto words = mask.words();
+        for (std::size_t key = 0; key * chunk_words < words.size(); ++key) {
+            auto chunk = words.subspan(key * chunk_words, std::min(chunk_words, words.size() - key * chunk_words));
+            std::size_t cardinality = 0;
+            for (auto word: chunk) {
+                cardinality += static_cast<std::size_t>(std::popcount(word));
+            }
+            if (cardinality == 0) {
+                continue;
+            }
+            Container c{key};
+            c.cardinality = cardinality;
+            if (cardinality <= array_limit) {
+                c.array = Container::offsets(chunk, cardinality);
+            } else {
+                c.bitmap.assign(chunk_words, 0);
+                std::ranges::copy(chunk, c.bitmap.begin());
+            }
+            m_containers.push_back(std::move(c));
+        }
+    }
+
+public: /* Public Methods */
+
+    auto size() const noexcept -> std::size_t { return m_size; }
+
+    auto count() const noexcept -> std::size_t {
+        return std::accumulate(m_containers.begin(), m_containers.end(), std::size_t{0},
+                               [](std::size_t total, Container const &c) { return total + c.cardinality; });
+    }
+
+    auto any() const noexcept -> bool { return !m_containers.empty(); }
+
+    auto none() const noexcept -> bool { return m_containers.empty(); }
+
+    auto all() const noexcept -> bool { return count() == m_size; }
+
+    auto test(std::size_t i) const noexcept -> bool {
+        auto it = std::ranges::lower_bound(m_containers, i / chunk_bits, {}, &Container::key);
+        return it != m_containers.end() && it->key == i / chunk_bits &&
+               it->contains(static_cast<std::uint16_t>(i % chunk_bits));
+    }
+
+    /// @brief fn(index) for every set bit, ascending
+    template<typename F>
+    auto for_each(F &&fn) const -> void {
+        for (auto const &c: m_containers) {
+            c.for_each(fn);
+        }
+    }
+
+    auto indices() const -> std::vector<std::size_t> {
+        std::vector<std::size_t> result;
+        result.reserve(count());
+        for_each([&](std::size_t i) { result.push_back(i); });
+        return result;
+    }
+
+    auto decompress() const -> ResultMask {
+        ResultMask mask(m_size);
+        auto words = mask.words();
+        for (auto const &c: m_containers) {
+            auto bitmap = c.to_bitmap();
+            auto base = c.key * chunk_words;
+            std::copy_n(bitmap.begin(), std::min(chunk_words, words.size() - base), words.begin() + base);
+        }
+        return mask;
+    }
+
+    /// @brief Bytes held by the containers, for comparison with size() / 8
+    auto memory_bytes() const noexcept -> std::size_t {
+        std::size_t bytes = m_containers.capacity() * sizeof(Container);
+        for (auto const &c: m_containers) {
+            bytes += c.array.capacity() * sizeof(std::uint16_t) + c.bitmap.capacity() * sizeof(std::uint64_t);
+        }
+        return bytes;
+    }
+
+    friend auto operator&(CompressedMask const &lhs, CompressedMask const &rhs) -> CompressedMask {
+        lhs.check_size(rhs);
+        CompressedMask result(lhs.m_size);
+        auto a = lhs.m_containers.begin();
+        auto b = rhs.m_containers.begin();
+        while (a != lhs.m_containers.end() && b != rhs.m_containers.end()) {
+            if (a->key < b->key) {
+                ++a;
+            } else if (b->key < a->key) {
+                ++b;
+            } else {
+                if (auto c = Container::intersect(*a, *b); c.cardinality) {
+                    result.m_containers.push_back(std::move(c));
+                }
+                ++a;
+                ++b;
+            }
+        }
+        return result;
+    }
+
+    friend auto operator|(CompressedMask const &lhs, CompressedMask const &rhs) -> CompressedMask {
+        lhs.check_size(rhs);
+        CompressedMask result(lhs.m_size);
+        auto a = lhs.m_containers.begin();
+        auto b = rhs.m_containers.begin();
+        while (a != lhs.m_containers.end() || b != rhs.m_containers.end()) {
+            if (b == rhs.m_containers.end() || (a != lhs.m_containers.end() && a->key < b->key)) {
+                result.m_containers.push_back(*a++);
+            } else if (a == lhs.m_containers.end() || b->key < a->key) {
+                result.m_containers.push_back(*b++);
+            } else {
+                result.m_containers.push_back(Container::unite(*a++, *b++));
+            }
+        }
+        return result;
+    }
+
+    auto operator&=(CompressedMask const &other) -> CompressedMask & { return *this = *this & other; }
+
+    auto operator|=(CompressedMask const &other) -> CompressedMask & { return *this = *this | other; }
+};
+
+
+#endif
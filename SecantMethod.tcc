@@ -6,40 +6,236 @@
 #define THREADED_SECANT_METHOD_TCC
 
 #include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <algorithm>
-#include <execution>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <span>
 #include <vector>
-#include <thread>
-#include <hash_map>
 
 
-// create a template that accepts a return type R, and a function template std::function<R(...)>
-template<typename R, std::function<R(...)> Phi>
+/// @brief Batched bracketed root finder: secant (or Newton, given a derivative) steps safeguarded by bisection.
+///
+/// Every lane starts from a bracket [lo, hi] with a sign change. A lane takes the interpolation step when it
+/// lands strictly inside its bracket and is under half the step before last (Brent's rule), otherwise it
+/// bisects, so each lane converges at least as fast as bisection whatever the function does.
+///
+/// Lane state is kept as one array per field. After every iteration finished lanes are written out and the
+/// remaining ones compacted to the front, so the update loops and the batch function always see a dense,
+/// contiguous set of live lanes and a few slow lanes do not leave the rest of the vector idle.
+template<std::floating_point R>
 class SecantMethod {
 
+public: /* Public types */
+
+    /// Evaluates y[i] = phi_lane[i](x[i]) for the live lanes; lane[i] is the lane's index in the original batch
+    using Function = std::function<void(std::span<R const> x, std::span<std::uint32_t const> lane, std::span<R> y)>;
+
+    enum class Status : std::uint8_t {
+        Converged = 0,
+        MaxIterations = 1,
+        NoBracket = 2,  ///< phi(lo) and phi(hi) have the same sign
+        NotFinite = 3,  ///< phi returned a non-finite value inside the bracket
+    };
+
+private: /* Private Members */
+
+    Function m_phi{};
+    Function m_derivative{};
+    R m_tolerance = std::sqrt(std::numeric_limits<R>::epsilon());
+    int m_max_iterations = 100;
+
+    /// Per-lane solver state, one array per field, live lanes in [0, size)
+    struct State {
+        std::vector<std::uint32_t> lane;
+        std::vector<R> lo, hi, f_lo, f_hi;  ///< bracket
+        std::vector<R> x, fx, dx;           ///< current iterate, phi and phi' there
+        std::vector<R> x_prev, f_prev;      ///< previous iterate, for the secant slope
+        std::vector<R> step, step_old;      ///< last two step lengths
+        std::vector<R> next, f_next, d_next;
+
+        explicit State(std::size_t n)
+                : lane(n), lo(n), hi(n), f_lo(n), f_hi(n), x(n), fx(n), dx(n), x_prev(n), f_prev(n), step(n),
+                  step_old(n), next(n), f_next(n), d_next(n) {}
+
+        /// @brief Move lane j to slot w
+        auto move(std::size_t w, std::size_t j) -> void {
+            for (auto *field: {&lo, &hi, &f_lo, &f_hi, &x, &fx, &dx, &x_prev, &f_prev, &step, &step_old}) {
+                (*field)[w] = (*field)[j];
+            }
+            lane[w] = lane[j];
+        }
+    };
+
+private: /* Private Methods */
+
+    static constexpr auto finite(R n) -> bool { return std::abs(n) <= std::numeric_limits<R>::max(); }
+
+    auto evaluate(Function const &f, std::span<R const> x, std::span<std::uint32_t const> lane, std::span<R> y) const
+    -> void {
+        if (!x.empty()) {
+            f(x, lane, y);
+        }
+    }
+
 public: /* Constructors */
 
     // default constructor
     SecantMethod() = default;
 
     // constructor that accepts a function template
-    explicit SecantMethod(std::function<R(...)> Phi) : Phi(Phi) {}
+    explicit SecantMethod(Function Phi) : m_phi(std::move(Phi)) {}
 
     // constructor that accepts a function template and a tolerance
-    SecantMethod(std::function<R(...)> Phi, R tolerance) : Phi(Phi), tolerance(tolerance) {}
+    SecantMethod(Function Phi, R tolerance) : m_phi(std::move(Phi)), m_tolerance(tolerance) {}
 
     // constructor that accepts a function template, a tolerance, and a maximum number of iterations
-    SecantMethod(std::function<R(...)> Phi, R tolerance, int maxIterations) : Phi(Phi), tolerance(tolerance),
-                                                                            maxIterations(maxIterations) {}
-
-
-private:
-
-
-public:
-
-
+    SecantMethod(Function Phi, R tolerance, int maxIterations) : m_phi(std::move(Phi)), m_tolerance(tolerance),
+                                                                 m_max_iterations(maxIterations) {}
+
+    // constructor that also accepts the analytic derivative, switching the interpolation step to Newton
+    SecantMethod(Function Phi, Function dPhi, R tolerance, int maxIterations)
+            : m_phi(std::move(Phi)), m_derivative(std::move(dPhi)), m_tolerance(tolerance),
+              m_max_iterations(maxIterations) {}
+
+public: /* Public Methods */
+
+    /// @brief Adapt a scalar per-lane function to the batch Function signature
+    static auto lanewise(std::function<R(R, std::uint32_t)> phi) -> Function {
+        return [phi = std::move(phi)](std::span<R const> x, std::span<std::uint32_t const> lane, std::span<R> y) {
+            for (std::size_t i = 0; i < x.size(); ++i) {
+                y[i] = phi(x[i], lane[i]);
+            }
+        };
+    }
+
+    /// @brief Find a root of every lane's function inside its bracket [lo[i], hi[i]]
+    /// @param root receives the root, or the last iterate for lanes that did not converge (NaN without a bracket)
+    /// @param status optional, receives each lane's Status
+    /// @return the number of converged lanes
+    auto solve(std::span<R const> lo, std::span<R const> hi, std::span<R> root, std::span<Status> status = {}) const
+    -> std::size_t {
+        auto n = std::min({lo.size(), hi.size(), root.size()});
+        bool newton = static_cast<bool>(m_derivative);
+        auto finish = [&](std::uint32_t lane, R x, Status s) {
+            root[lane] = x;
+            if (!status.empty()) {
+                status[lane] = s;
+            }
+        };
+
+        State s(n);
+        std::iota(s.lane.begin(), s.lane.end(), std::uint32_t{0});
+        std::copy_n(lo.begin(), n, s.lo.begin());
+        std::copy_n(hi.begin(), n, s.hi.begin());
+        evaluate(m_phi, s.lo, s.lane, s.f_lo);
+        evaluate(m_phi, s.hi, s.lane, s.f_hi);
+
+        /* Drop lanes solved or unsolvable at the endpoints; start the rest from the endpoint nearer a root */
+        std::size_t converged = 0;
+        std::size_t live = 0;
+        for (std::size_t j = 0; j < n; ++j) {
+            auto fa = s.f_lo[j];
+            auto fb = s.f_hi[j];
+            if (fa == 0 || fb == 0) {
+                finish(s.lane[j], fa == 0 ? s.lo[j] : s.hi[j], Status::Converged);
+                ++converged;
+                continue;
+            }
+            if (!finite(fa) || !finite(fb)) {
+                finish(s.lane[j], std::numeric_limits<R>::quiet_NaN(), Status::NotFinite);
+                continue;
+            }
+            if (std::signbit(fa) == std::signbit(fb)) {
+                finish(s.lane[j], std::numeric_limits<R>::quiet_NaN(), Status::NoBracket);
+                continue;
+            }
+            bool low = std::abs(fa) < std::abs(fb);
+            s.x[j] = low ? s.lo[j] : s.hi[j];
+            s.fx[j] = low ? fa : fb;
+            s.x_prev[j] = low ? s.hi[j] : s.lo[j];
+            s.f_prev[j] = low ? fb : fa;
+            s.step[j] = s.step_old[j] = s.hi[j] - s.lo[j];
+            s.move(live++, j);
+        }
+        if (newton) {
+            evaluate(m_derivative, std::span<R const>(s.x).first(live), std::span(s.lane).first(live),
+                     std::span(s.dx).first(live));
+        }
+
+        for (int iteration = 0; iteration < m_max_iterations && live > 0; ++iteration) {
+
+            /* Candidate points, branch-free over the dense live lanes */
+            for (std::size_t j = 0; j < live; ++j) {
+                auto x = s.x[j];
+                auto fx = s.fx[j];
+                auto slope = newton ? s.dx[j] : (fx - s.f_prev[j]) / (x - s.x_prev[j]);
+                auto interp = x - fx / slope;
+                auto mid = s.lo[j] + (s.hi[j] - s.lo[j]) / 2;
+
+                /* NaN and infinite candidates fail the inside test and fall back to bisection */
+                bool inside = (interp - s.lo[j]) * (interp - s.hi[j]) < 0;
+                bool fast = std::abs(interp - x) < std::abs(s.step_old[j]) / 2;
+                bool take = inside && fast;
+                s.next[j] = take ? interp : mid;
+                s.step_old[j] = take ? s.step[j] : s.hi[j] - s.lo[j];
+                s.step[j] = take ? interp - x : s.hi[j] - s.lo[j];
+            }
+
+            evaluate(m_phi, std::span<R const>(s.next).first(live), std::span(s.lane).first(live),
+                     std::span(s.f_next).first(live));
+            if (newton) {
+                evaluate(m_derivative, std::span<R const>(s.next).first(live), std::span(s.lane).first(live),
+                         std::span(s.d_next).first(live));
+            }
+
+            /* Shrink the brackets, retire finished lanes and compact the rest */
+            std::size_t kept = 0;
+            for (std::size_t j = 0; j < live; ++j) {
+                auto c = s.next[j];
+                auto fc = s.f_next[j];
+                bool left = std::signbit(fc) == std::signbit(s.f_lo[j]);
+                s.lo[j] = left ? c : s.lo[j];
+                s.f_lo[j] = left ? fc : s.f_lo[j];
+                s.hi[j] = left ? s.hi[j] : c;
+                s.f_hi[j] = left ? s.f_hi[j] : fc;
+                s.x_prev[j] = s.x[j];
+                s.f_prev[j] = s.fx[j];
+                s.x[j] = c;
+                s.fx[j] = fc;
+                s.dx[j] = s.d_next[j];
+
+                auto tolerance = m_tolerance * (1 + std::abs(c));
+                if (!finite(fc)) {
+                    finish(s.lane[j], c, Status::NotFinite);
+                } else if (fc == 0 || s.hi[j] - s.lo[j] <= tolerance || std::abs(c - s.x_prev[j]) <= tolerance) {
+                    finish(s.lane[j], c, Status::Converged);
+                    ++converged;
+                } else {
+                    s.move(kept++, j);
+                }
+            }
+            live = kept;
+        }
+
+        for (std::size_t j = 0; j < live; ++j) {
+            finish(s.lane[j], s.x[j], Status::MaxIterations);
+        }
+        return converged;
+    }
+
+    /// @brief Scalar convenience over lane 0
+    auto solve(R lo, R hi) const -> std::optional<R> {
+        R root{};
+        Status status{};
+        solve(std::span<R const>(&lo, 1), std::span<R const>(&hi, 1), std::span<R>(&root, 1),
+              std::span<Status>(&status, 1));
+        return status == Status::Converged ? std::optional<R>(root) : std::nullopt;
+    }
 };
 
 
@@ -0,0 +1 @@
+#include "SharedBatch.tcc"
@@ -0,0 +1,325 @@
+#ifndef THREADED_SHARED_BATCH_TCC
+#define THREADED_SHARED_BATCH_TCC
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "CpuDispatch.tcc"
+#include "NPlus.tcc"
+
+
+#if defined(__linux__)
+
+/// @brief Batch of checked additions shared between processes through POSIX shared memory.
+///
+/// A coordinator creates a named segment holding the operands, results and flags of one batch, fills the
+/// operands in place and publishes them. Worker processes attach to the same name and run the overflow
+/// check and NPlus<T, Policy> kernels over the slices they claim, writing results straight into the
+/// segment, so no process keeps its own copy of the inputs. Slices are claimed and completion counted with
+/// lock-free atomics in the segment header; waiting parks on shared futexes over those same words.
+template<typename T, OverflowPolicy Policy = default_overflow_policy<T>>
+requires std::is_arithmetic_v<T>
+class SharedBatch {
+
+public: /* Public types */
+
+    using result_type = typename NPlus<T, Policy>::result_type;
+
+private: /* Private types */
+
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free && std::atomic<std::uint64_t>::is_always_lock_free,
+                  "SharedBatch needs address-free (lock-free) atomics in the shared segment");
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "futex words must be 32 bits");
+
+    static constexpr std::uint64_t magic = 0x314D485344524854;  // "THRDSHM1"
+    static constexpr std::size_t huge_page = 2 << 20;
+
+    /// Segment layout: this header, then lhs, rhs, out and flags arrays at 64-byte aligned offsets
+    struct Header {
+        std::uint64_t magic;
+        std::uint32_t element_size;
+        std::uint32_t result_size;
+        std::uint64_t capacity;
+        std::uint32_t slice_count;
+
+        /* Coordinator to workers: a new batch (or shutdown) is available */
+        alignas(64) std::atomic<std::uint32_t> generation;
+        std::atomic<std::uint32_t> shutdown;
+        std::atomic<std::uint64_t> batch_size;
+
+        /* Workers to coordinator, on their own line so claiming does not bounce the generation line */
+        alignas(64) std::atomic<std::uint32_t> next_slice;
+        std::atomic<std::uint32_t> slices_done;
+        std::atomic<std::uint64_t> flagged;
+        std::atomic<std::uint64_t> slow_lanes;
+    };
+
+    static constexpr auto align(std::size_t offset, std::size_t to = 64) -> std::size_t {
+        return (offset + to - 1) / to * to;
+    }
+
+    struct Layout {
+        std::size_t lhs, rhs, out, flags, bytes;
+    };
+
+    static constexpr auto layout(std::size_t capacity, bool huge) -> Layout {
+        Layout l{};
+        l.lhs = align(sizeof(Header));
+        l.rhs = align(l.lhs + capacity * sizeof(T));
+        l.out = align(l.rhs + capacity * sizeof(T));
+        l.flags = align(l.out + capacity * sizeof(result_type));
+        l.bytes = align(l.flags + capacity, huge ? huge_page : 4096);
+        return l;
+    }
+
+private: /* Private Members */
+
+    std::string m_name{};
+    void *m_base = nullptr;
+    std::size_t m_bytes = 0;
+    bool m_owner = false;
+    bool m_huge_pages = false;
+
+private: /* Private Methods */
+
+    auto header() const noexcept -> Header & { return *static_cast<Header *>(m_base); }
+
+    template<typename U>
+    auto array(std::size_t offset, std::size_t n) const noexcept -> std::span<U> {
+        return {reinterpret_cast<U *>(static_cast<std::byte *>(m_base) + offset), n};
+    }
+
+    static auto fail(char const *what) -> void { throw std::system_error(errno, std::generic_category(), what); }
+
+    static auto futex_wait(std::atomic<std::uint32_t> &word, std::uint32_t expected) noexcept -> void {
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+    }
+
+    static auto futex_wake_all(std::atomic<std::uint32_t> &word) noexcept -> void {
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&word), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+    }
+
+    auto map(int fd, std::size_t bytes) -> void {
+        m_base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (m_base == MAP_FAILED) {
+            m_base = nullptr;
+            fail("SharedBatch: mmap");
+        }
+        m_bytes = bytes;
+    }
+
+    SharedBatch() = default;
+
+public: /* Constructors */
+
+    /// @brief Create the segment; fails if name already exists
+    /// @param slices units of work handed out to processes, fixed for the life of the segment
+    /// @param huge_pages ask for transparent huge pages (needs shmem_enabled in
+    ///        /sys/kernel/mm/transparent_hugepage); huge_pages() reports whether the kernel accepted
+    static auto create(std::string name, std::size_t capacity, std::uint32_t slices, bool huge_pages = true)
+    -> SharedBatch {
+        if (slices == 0) {
+            throw std::invalid_argument("SharedBatch: at least one slice is needed");
+        }
+        SharedBatch batch;
+        batch.m_name = std::move(name);
+        auto l = layout(capacity, huge_pages);
+
+        auto fd = shm_open(batch.m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            fail("SharedBatch: shm_open");
+        }
+        batch.m_owner = true;
+        if (ftruncate(fd, static_cast<off_t>(l.bytes)) != 0) {
+            close(fd);
+            fail("SharedBatch: ftruncate");
+        }
+        batch.map(fd, l.bytes);
+        batch.m_huge_pages = huge_pages && madvise(batch.m_base, l.bytes, MADV_HUGEPAGE) == 0;
+
+        /* The header becomes valid for attach() once magic is published */
+        auto &h = *new(batch.m_base) Header{};
+        h.element_size = sizeof(T);
+        h.result_size = sizeof(result_type);
+        h.capacity = capacity;
+        h.slice_count = slices;
+        h.next_slice.store(slices, std::memory_order_relaxed);
+        h.slices_done.store(slices, std::memory_order_relaxed);
+        std::atomic_ref(h.magic).store(magic, std::memory_order_release);
+        return batch;
+    }
+
+    /// @brief Attach to a segment made by create() with the same T and Policy
+    static auto attach(std::string name) -> SharedBatch {
+        SharedBatch batch;
+        batch.m_name = std::move(name);
+        auto fd = shm_open(batch.m_name.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            fail("SharedBatch: shm_open");
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+            close(fd);
+            throw std::runtime_error("SharedBatch: segment too small");
+        }
+        batch.map(fd, static_cast<std::size_t>(st.st_size));
+
+        auto &h = batch.header();
+        if (std::atomic_ref(h.magic).load(std::memory_order_acquire) != magic || h.element_size != sizeof(T) ||
+            h.result_size != sizeof(result_type) ||
+            layout(h.capacity, false).flags + h.capacity > batch.m_bytes) {
+            throw std::runtime_error("SharedBatch: segment was created for another element type");
+        }
+        return batch;
+    }
+
+    SharedBatch(SharedBatch &&other) noexcept
+            : m_name(std::move(other.m_name)), m_base(std::exchange(other.m_base, nullptr)),
+              m_bytes(other.m_bytes), m_owner(std::exchange(other.m_owner, false)), m_huge_pages(other.m_huge_pages) {}
+
+    SharedBatch &operator=(SharedBatch &&other) noexcept {
+        std::swap(m_name, other.m_name);
+        std::swap(m_base, other.m_base);
+        std::swap(m_bytes, other.m_bytes);
+        std::swap(m_owner, other.m_owner);
+        std::swap(m_huge_pages, other.m_huge_pages);
+        return *this;
+    }
+
+    SharedBatch(SharedBatch const &) = delete;
+
+    SharedBatch &operator=(SharedBatch const &) = delete;
+
+    /// @brief Unmaps; the creator also unlinks the name (attached processes keep their mapping)
+    ~SharedBatch() {
+        if (m_base) {
+            munmap(m_base, m_bytes);
+        }
+        if (m_owner) {
+            shm_unlink(m_name.c_str());
+        }
+    }
+
+public: /* Public Methods */
+
+    auto capacity() const noexcept -> std::size_t { return header().capacity; }
+
+    auto huge_pages() const noexcept -> bool { return m_huge_pages; }
+
+    /* In-place views of the segment; operands are written by the coordinator before publish() */
+
+    auto lhs() const noexcept -> std::span<T> { return array<T>(layout(capacity(), false).lhs, capacity()); }
+
+    auto rhs() const noexcept -> std::span<T> { return array<T>(layout(capacity(), false).rhs, capacity()); }
+
+    auto out() const noexcept -> std::span<result_type> {
+        return array<result_type>(layout(capacity(), false).out, capacity());
+    }
+
+    auto flags() const noexcept -> std::span<std::uint8_t> {
+        return array<std::uint8_t>(layout(capacity(), false).flags, capacity());
+    }
+
+    /// @brief Coordinator: make the first n operand pairs the current batch and wake the workers.
+    /// The previous batch must have completed.
+    auto publish(std::size_t n) -> void {
+        auto &h = header();
+        h.batch_size.store(std::min<std::size_t>(n, h.capacity), std::memory_order_relaxed);
+        h.flagged.store(0, std::memory_order_relaxed);
+        h.slow_lanes.store(0, std::memory_order_relaxed);
+        h.slices_done.store(0, std::memory_order_relaxed);
+        h.next_slice.store(0, std::memory_order_release);
+        h.generation.fetch_add(1, std::memory_order_release);
+        futex_wake_all(h.generation);
+    }
+
+    /// @brief Claim and process slices of the current batch until none is left; any process may call this
+    /// @return the number of slices this call processed
+    auto drain() -> std::size_t {
+        auto &h = header();
+        std::size_t processed = 0;
+        for (auto s = h.next_slice.fetch_add(1, std::memory_order_acq_rel); s < h.slice_count;
+             s = h.next_slice.fetch_add(1, std::memory_order_acq_rel)) {
+            auto n = h.batch_size.load(std::memory_order_relaxed);
+            auto begin = n * s / h.slice_count;
+            auto len = n * (s + 1) / h.slice_count - begin;
+
+            auto a = std::span<T const>(lhs().subspan(begin, len));
+            auto b = std::span<T const>(rhs().subspan(begin, len));
+            auto flagged = CpuDispatch::overflow_check<T>(a, b, flags().subspan(begin, len));
+            auto slow = CpuDispatch::nplus<T, Policy>(a, b, out().subspan(begin, len));
+            h.flagged.fetch_add(flagged, std::memory_order_relaxed);
+            h.slow_lanes.fetch_add(slow, std::memory_order_relaxed);
+            ++processed;
+
+            if (h.slices_done.fetch_add(1, std::memory_order_acq_rel) + 1 == h.slice_count) {
+                futex_wake_all(h.slices_done);
+            }
+        }
+        return processed;
+    }
+
+    /// @brief Coordinator: block until every slice of the current batch is done
+    /// @return the number of flagged (overflowing) lanes in the batch
+    auto wait() const -> std::size_t {
+        auto &h = header();
+        for (auto done = h.slices_done.load(std::memory_order_acquire); done < h.slice_count;
+             done = h.slices_done.load(std::memory_order_acquire)) {
+            futex_wait(h.slices_done, done);
+        }
+        return h.flagged.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Lanes of the last completed batch that took the NPlus slow path
+    auto slow_lanes() const noexcept -> std::size_t { return header().slow_lanes.load(std::memory_order_relaxed); }
+
+    /// @brief Worker: process batches as they are published until shutdown()
+    /// @return the number of slices this process handled
+    auto serve() -> std::size_t {
+        auto &h = header();
+        std::size_t processed = 0;
+        for (;;) {
+            auto seen = h.generation.load(std::memory_order_acquire);
+            if (h.shutdown.load(std::memory_order_acquire)) {
+                return processed;
+            }
+            processed += drain();
+            while (h.generation.load(std::memory_order_acquire) == seen) {
+                futex_wait(h.generation, seen);
+            }
+        }
+    }
+
+    /// @brief Coordinator: make every serve() return once its current slice is done
+    auto shutdown() -> void {
+        auto &h = header();
+        h.shutdown.store(1, std::memory_order_release);
+        h.generation.fetch_add(1, std::memory_order_release);
+        futex_wake_all(h.generation);
+    }
+};
+
+#endif
+
+
+#endif
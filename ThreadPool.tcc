@@ -0,0 +1,515 @@
+#ifndef THREADED_THREAD_POOL_TCC
+#define THREADED_THREAD_POOL_TCC
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <ranges>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "Instrumentation.tcc"
+
+
+/// Scheduling class of a pool task; a worker always takes the most urgent non-empty lane first
+enum class Priority : std::uint8_t {
+    High = 0,
+    Normal = 1,
+    Low = 2,
+    Count = 3,
+};
+
+
+/// @brief Log2-bucketed histogram of queueing latencies (nanoseconds), safe to record from any thread
+class LatencyHistogram {
+
+public: /* Public types */
+
+    /// Bucket b counts latencies in [2^(b-1), 2^b) ns; bucket 0 counts zero
+    static constexpr std::size_t buckets = 64;
+
+private: /* Private Members */
+
+    std::array<std::atomic<std::uint64_t>, buckets> m_counts{};
+
+public: /* Public Methods */
+
+    auto record(std::chrono::nanoseconds latency) noexcept -> void {
+        auto ns = static_cast<std::uint64_t>(std::max<std::chrono::nanoseconds::rep>(latency.count(), 0));
+        auto bucket = std::min<std::size_t>(static_cast<std::size_t>(std::bit_width(ns)), buckets - 1);
+        m_counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto counts() const noexcept -> std::array<std::uint64_t, buckets> {
+        std::array<std::uint64_t, buckets> result{};
+        for (std::size_t b = 0; b < buckets; ++b) {
+            result[b] = m_counts[b].load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    auto total() const noexcept -> std::uint64_t {
+        auto c = counts();
+        return std::accumulate(c.begin(), c.end(), std::uint64_t{0});
+    }
+
+    /// @brief Upper bound of the bucket holding the q-quantile (q in [0, 1]), zero when nothing was recorded
+    auto percentile(double q) const noexcept -> std::chrono::nanoseconds {
+        auto c = counts();
+        auto rank = static_cast<std::uint64_t>(q * static_cast<double>(total()));
+        std::uint64_t seen = 0;
+        for (std::size_t b = 0; b < buckets; ++b) {
+            seen += c[b];
+            if (c[b] && seen > rank) {
+                return std::chrono::nanoseconds(b ? (std::int64_t{1} << std::min<std::size_t>(b, 62)) - 1 : 0);
+            }
+        }
+        return std::chrono::nanoseconds(0);
+    }
+
+    auto reset() noexcept -> void {
+        for (auto &count: m_counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+
+/// @brief Tuning knobs of ThreadPool::parallel_for
+struct ParallelForOptions {
+    /// Elements per chunk; 0 lets every thread tune its own grain from the measured per-element cost
+    std::size_t grain = 0;
+
+    /// Wall time an automatically sized chunk aims for: long enough to amortize scheduling, short enough to
+    /// leave something for thieves and to yield to urgent tasks promptly
+    std::chrono::nanoseconds target_chunk = std::chrono::microseconds(50);
+
+    Priority priority = Priority::Normal;
+};
+
+
+/// @brief What one parallel_for call did
+struct ParallelForStats {
+    std::size_t elements = 0;
+    std::size_t chunks = 0;
+    std::size_t steals = 0;          ///< range splits made because a thread ran out of work
+    std::size_t participants = 0;    ///< threads that joined while work was left, the caller included
+    double ns_per_element = 0;       ///< summed busy time over elements
+    std::size_t final_grain = 0;     ///< grain the calling thread ended with; a good fixed grain for reruns
+    std::chrono::nanoseconds wall{};
+};
+
+
+/// @brief Fixed set of worker threads fed from prioritized task lanes.
+///
+/// Each Priority has its own lane, ordered earliest deadline first with submission order breaking ties (so
+/// tasks without a deadline run FIFO). Workers always drain the most urgent lane first, and the helpers of a
+/// for_each_index call give their thread back between indices whenever a more urgent task is waiting, so a
+/// large background loop delays latency-critical work by at most one index.
+///
+/// for_each_index() is the fork-join entry point the numeric kernels use: the calling thread takes part in
+/// the work, so a call made from inside a worker (nested parallelism) still completes even if every other
+/// worker is busy.
+class ThreadPool {
+
+public: /* Public types */
+
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr Clock::time_point no_deadline = Clock::time_point::max();
+
+private: /* Private types */
+
+    static constexpr std::size_t lanes = static_cast<std::size_t>(Priority::Count);
+
+    struct Task {
+        std::function<void()> fn;
+        Clock::time_point deadline;
+        std::uint64_t sequence;
+        Clock::time_point queued;
+
+        /// Heap order: the top is the earliest deadline, then the earliest submission
+        friend auto operator<(Task const &lhs, Task const &rhs) noexcept -> bool {
+            return lhs.deadline != rhs.deadline ? lhs.deadline > rhs.deadline : lhs.sequence > rhs.sequence;
+        }
+    };
+
+private: /* Private Members */
+
+    std::vector<std::jthread> m_workers{};
+    std::array<std::vector<Task>, lanes> m_lanes{};
+    std::array<std::atomic<std::size_t>, lanes> m_queued{};
+    std::array<LatencyHistogram, lanes> m_latency{};
+    std::uint64_t m_sequence = 0;
+    std::mutex m_mutex{};
+    std::condition_variable m_cv{};
+    bool m_stopping = false;
+
+private: /* Private Methods */
+
+    /// @brief Pop the most urgent task; the caller holds m_mutex and has checked that one exists
+    auto pop_locked() -> std::pair<Task, std::size_t> {
+        for (std::size_t lane = 0;; ++lane) {
+            auto &heap = m_lanes[lane];
+            if (!heap.empty()) {
+                std::pop_heap(heap.begin(), heap.end());
+                auto task = std::move(heap.back());
+                heap.pop_back();
+                m_queued[lane].fetch_sub(1, std::memory_order_relaxed);
+                return {std::move(task), lane};
+            }
+        }
+    }
+
+    auto empty_locked() const noexcept -> bool {
+        return std::all_of(m_lanes.begin(), m_lanes.end(), [](auto const &heap) { return heap.empty(); });
+    }
+
+    auto worker_loop() -> void {
+        for (;;) {
+            Task task;
+            std::size_t lane;
+            {
+                std::unique_lock lock(m_mutex);
+                if (empty_locked() && !m_stopping) {
+                    Instrumentation::add(Instrumentation::Counter::Parks);
+                    m_cv.wait(lock, [this] { return m_stopping || !empty_locked(); });
+                }
+                if (empty_locked()) {
+                    return;
+                }
+                std::tie(task, lane) = pop_locked();
+            }
+            m_latency[lane].record(Clock::now() - task.queued);
+            Instrumentation::add(Instrumentation::Counter::TasksRun);
+            task.fn();
+        }
+    }
+
+public: /* Constructors */
+
+    /// @param threads worker count, 0 picks one per hardware thread less the calling thread
+    explicit ThreadPool(std::size_t threads = 0) {
+        if (threads == 0) {
+            threads = std::max<std::size_t>(1, std::thread::hardware_concurrency()) - 1;
+        }
+        m_workers.reserve(threads);
+        for (std::size_t t = 0; t < threads; ++t) {
+            m_workers.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    ThreadPool(ThreadPool const &) = delete;
+
+    ThreadPool &operator=(ThreadPool const &) = delete;
+
+    /// @brief Finishes every queued task, then joins the workers
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+        m_cv.notify_all();
+        m_workers.clear();
+    }
+
+public: /* Public Methods */
+
+    /// @brief Process-wide pool sized to the machine
+    static auto shared() -> ThreadPool & {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    /// @brief Threads taking part in a for_each_index call: the workers plus the caller
+    auto concurrency() const noexcept -> std::size_t { return m_workers.size() + 1; }
+
+    /// @param deadline orders the task within its lane, earliest first
+    auto submit(std::function<void()> task, Priority priority = Priority::Normal,
+                Clock::time_point deadline = no_deadline) -> void {
+        auto lane = static_cast<std::size_t>(priority);
+        {
+            std::lock_guard lock(m_mutex);
+            auto &heap = m_lanes[lane];
+            heap.push_back({std::move(task), deadline, m_sequence++, Clock::now()});
+            std::push_heap(heap.begin(), heap.end());
+            m_queued[lane].fetch_add(1, std::memory_order_relaxed);
+        }
+        m_cv.notify_one();
+    }
+
+    /// @brief True when a task more urgent than priority is waiting; long-running tasks poll this to yield
+    auto preempt_requested(Priority priority) const noexcept -> bool {
+        for (std::size_t lane = 0; lane < static_cast<std::size_t>(priority); ++lane) {
+            if (m_queued[lane].load(std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @brief Time tasks of the given priority spent queued before a worker picked them up
+    auto latency(Priority priority) const noexcept -> LatencyHistogram const & {
+        return m_latency[static_cast<std::size_t>(priority)];
+    }
+
+    auto reset_latency() noexcept -> void {
+        for (auto &histogram: m_latency) {
+            histogram.reset();
+        }
+    }
+
+    /// @brief Run fn(i) for every i in [0, n) across the pool and wait for all of them.
+    ///
+    /// Indices are claimed dynamically, so uneven items balance out. Helpers run in the given priority lane
+    /// and requeue themselves between indices when more urgent work is waiting. The first exception thrown
+    /// by fn is rethrown here once every claimed index has finished.
+    template<typename F>
+    auto for_each_index(std::size_t n, F &&fn, Priority priority = Priority::Normal) -> void {
+        if (n == 0) {
+            return;
+        }
+        if (n == 1 || m_workers.empty()) {
+            for (std::size_t i = 0; i < n; ++i) {
+                fn(i);
+            }
+            return;
+        }
+
+        /* Helpers may still be queued after the caller returns, so the shared state outlives this frame */
+        struct State {
+            std::atomic<std::size_t> next{0};
+            std::atomic<std::size_t> done{0};
+            std::size_t count = 0;
+            std::exception_ptr error{};
+            std::mutex error_mutex{};
+        };
+
+        auto state = std::make_shared<State>();
+        state->count = n;
+
+        /* Helpers stop early (returning true) when preemptible and more urgent work is queued */
+        auto drain = [this, state, &fn, priority](bool preemptible) {
+            for (auto i = state->next.fetch_add(1); i < state->count; i = state->next.fetch_add(1)) {
+                try {
+                    fn(i);
+                } catch (...) {
+                    std::lock_guard lock(state->error_mutex);
+                    if (!state->error) {
+                        state->error = std::current_exception();
+                    }
+                }
+                if (state->done.fetch_add(1, std::memory_order_acq_rel) + 1 == state->count) {
+                    state->done.notify_all();
+                }
+                if (preemptible && preempt_requested(priority)) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        /* fn is only touched by helpers that claim an index, and no index is left once the caller returns */
+        auto helper = [this, state, drain, priority](auto const &self) -> void {
+            if (state->next.load(std::memory_order_relaxed) < state->count) {
+                if (drain(true)) {
+                    submit([self] { self(self); }, priority);
+                }
+            }
+        };
+        auto helpers = std::min(n - 1, m_workers.size());
+        for (std::size_t h = 0; h < helpers; ++h) {
+            submit([helper] { helper(helper); }, priority);
+        }
+        drain(false);
+
+        for (auto done = state->done.load(std::memory_order_acquire); done != n;
+             done = state->done.load(std::memory_order_acquire)) {
+            state->done.wait(done);
+        }
+
+        if (state->error) {
+            std::rethrow_exception(state->error);
+        }
+    }
+
+    /// @brief Apply fn to every element of range across the pool and wait for all of them.
+    ///
+    /// The whole range starts with the calling thread. A thread that runs out of work steals the back half of
+    /// the largest remaining range, so ranges are split lazily, only as often as threads actually go idle.
+    /// Each thread takes chunks of `grain` elements off the front of its own range; with automatic grain it
+    /// times every chunk and resizes the next one so it lasts about options.target_chunk, which keeps cheap
+    /// functors from drowning in overhead and lets threads on expensive regions of a skewed range split
+    /// them finely. The first exception thrown by fn is rethrown once every element has been visited.
+    template<std::ranges::random_access_range Range, typename F>
+    auto parallel_for(Range &&range, F &&fn, ParallelForOptions options = {}) -> ParallelForStats {
+        auto start = Clock::now();
+        auto n = static_cast<std::size_t>(std::ranges::size(range));
+        auto first = std::ranges::begin(range);
+
+        ParallelForStats stats;
+        stats.elements = n;
+        if (n == 0) {
+            return stats;
+        }
+
+        /* One slot per participant: the not yet started part of its current range */
+        struct alignas(64) Slot {
+            std::mutex mutex{};
+            std::size_t begin = 0;
+            std::size_t end = 0;
+        };
+
+        struct State {
+            std::vector<Slot> slots;
+            std::atomic<std::size_t> joined{0};
+            std::atomic<std::size_t> done{0};
+            std::atomic<std::size_t> chunks{0};
+            std::atomic<std::size_t> steals{0};
+            std::atomic<std::int64_t> busy_ns{0};
+            std::size_t count = 0;
+            std::exception_ptr error{};
+            std::mutex error_mutex{};
+
+            explicit State(std::size_t participants) : slots(participants) {}
+        };
+
+        auto helpers = std::min(n - 1, m_workers.size());
+        auto state = std::make_shared<State>(helpers + 1);
+        state->count = n;
+        state->slots[0].end = n;
+
+        /* Take the back half (all of a single element) of the fullest other range; false once all are empty */
+        auto steal = [state](std::size_t me) -> bool {
+            for (;;) {
+                std::size_t victim = me;
+                std::size_t most = 0;
+                for (std::size_t v = 0; v < state->slots.size(); ++v) {
+                    std::lock_guard lock(state->slots[v].mutex);
+                    if (v != me && state->slots[v].end - state->slots[v].begin > most) {
+                        victim = v;
+                        most = state->slots[v].end - state->slots[v].begin;
+                    }
+                }
+                if (victim == me) {
+                    return false;
+                }
+                std::scoped_lock lock(state->slots[victim].mutex, state->slots[me].mutex);
+                auto &from = state->slots[victim];
+                if (from.end == from.begin) {
+                    continue;
+                }
+                auto mid = from.begin + (from.end - from.begin) / 2;
+                state->slots[me].begin = mid;
+                state->slots[me].end = from.end;
+                from.end = mid;
+                state->steals.fetch_add(1, std::memory_order_relaxed);
+                Instrumentation::add(Instrumentation::Counter::Steals);
+                return true;
+            }
+        };
+
+        /* Work through slot me, then steal; returns true when it stopped early to yield to urgent tasks */
+        auto run = [this, state, steal, first, &fn, options](std::size_t me, std::size_t &grain, bool yielding) {
+            auto &own = state->slots[me];
+            for (;;) {
+                std::size_t b;
+                std::size_t e;
+                {
+                    std::lock_guard lock(own.mutex);
+                    b = own.begin;
+                    e = std::min(own.end, own.begin + grain);
+                    own.begin = e;
+                }
+                if (b == e) {
+                    if (!steal(me)) {
+                        return false;
+                    }
+                    continue;
+                }
+
+                auto chunk_start = Clock::now();
+                try {
+                    for (auto i = b; i < e; ++i) {
+                        std::invoke(fn, first[static_cast<std::iter_difference_t<decltype(first)>>(i)]);
+                    }
+                } catch (...) {
+                    std::lock_guard lock(state->error_mutex);
+                    if (!state->error) {
+                        state->error = std::current_exception();
+                    }
+                }
+                auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - chunk_start);
+                state->busy_ns.fetch_add(elapsed.count(), std::memory_order_relaxed);
+                state->chunks.fetch_add(1, std::memory_order_relaxed);
+
+                /* At most double per chunk, so one lucky fast chunk cannot make the next one huge */
+                if (options.grain == 0) {
+                    auto per_element = std::max<double>(1.0, static_cast<double>(elapsed.count()) /
+                                                             static_cast<double>(e - b));
+                    auto ideal = static_cast<double>(options.target_chunk.count()) / per_element;
+                    grain = std::clamp<std::size_t>(static_cast<std::size_t>(ideal), 1, 2 * grain);
+                }
+
+                if (state->done.fetch_add(e - b, std::memory_order_acq_rel) + (e - b) == state->count) {
+                    state->done.notify_all();
+                }
+                if (yielding && preempt_requested(options.priority)) {
+                    return true;
+                }
+            }
+        };
+
+        auto initial_grain = options.grain ? options.grain : 1;
+        for (std::size_t h = 1; h <= helpers; ++h) {
+            auto helper = [this, state, run, initial_grain, options, h](auto const &self, std::size_t grain) -> void {
+                if (state->done.load(std::memory_order_relaxed) < state->count) {
+                    if (grain == 0) {
+                        state->joined.fetch_add(1, std::memory_order_relaxed);
+                        grain = initial_grain;
+                    }
+                    if (run(h, grain, true)) {
+                        submit([self, grain] { self(self, grain); }, options.priority);
+                    }
+                }
+            };
+            submit([helper] { helper(helper, 0); }, options.priority);
+        }
+
+        auto grain = initial_grain;
+        run(0, grain, false);
+        for (auto done = state->done.load(std::memory_order_acquire); done != n;
+             done = state->done.load(std::memory_order_acquire)) {
+            state->done.wait(done);
+        }
+
+        stats.chunks = state->chunks.load(std::memory_order_relaxed);
+        stats.steals = state->steals.load(std::memory_order_relaxed);
+        stats.participants = 1 + state->joined.load(std::memory_order_relaxed);
+        stats.ns_per_element = static_cast<double>(state->busy_ns.load(std::memory_order_relaxed)) /
+                               static_cast<double>(n);
+        stats.final_grain = grain;
+        stats.wall = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+
+        if (state->error) {
+            std::rethrow_exception(state->error);
+        }
+        return stats;
+    }
+};
+
+
+#endif
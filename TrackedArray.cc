@@ -0,0 +1 @@
+#include "TrackedArray.tcc"
@@ -0,0 +1,286 @@
+#ifndef THREADED_TRACKED_ARRAY_TCC
+#define THREADED_TRACKED_ARRAY_TCC
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "CpuDispatch.tcc"
+#include "NPlus.tcc"
+#include "ResultMask.tcc"
+#include "ThreadPool.tcc"
+
+
+/// @brief Fixed-size array that remembers which 4 KiB blocks were written since the last clear_dirty().
+///
+/// Every write goes through set(), write() or modify(), which mark the blocks they touch. The dirty blocks are
+/// kept both as bits and as a list, so marking is O(1) per block and a consumer walks only the blocks that
+/// changed. The list has a single consumer: whoever calls clear_dirty().
+template<typename T>
+class TrackedArray {
+
+public: /* Public types */
+
+    /// Elements per tracked block, one page worth
+    static constexpr std::size_t block = std::max<std::size_t>(std::bit_floor(4096 / sizeof(T)), 1);
+
+private: /* Private Members */
+
+    std::vector<T> m_data;
+    ResultMask m_dirty_bits;
+    std::vector<std::size_t> m_dirty;
+
+public: /* Constructors */
+
+    explicit TrackedArray(std::vector<T> data)
+            : m_data(std::move(data)), m_dirty_bits(blocks()), m_dirty() {
+        mark_all();
+    }
+
+    explicit TrackedArray(std::size_t size, T value = T{}) : TrackedArray(std::vector<T>(size, value)) {}
+
+public: /* Public Methods */
+
+    auto size() const noexcept -> std::size_t { return m_data.size(); }
+
+    auto blocks() const noexcept -> std::size_t { return (m_data.size() + block - 1) / block; }
+
+    auto operator[](std::size_t i) const noexcept -> T const & { return m_data[i]; }
+
+    auto view() const noexcept -> std::span<T const> { return m_data; }
+
+    /// @brief Elements of block b (the last block may be short)
+    auto block_view(std::size_t b) const noexcept -> std::span<T const> {
+        auto begin = b * block;
+        return std::span<T const>(m_data).subspan(begin, std::min(block, m_data.size() - begin));
+    }
+
+    auto mark_dirty(std::size_t begin, std::size_t end) -> void {
+        end = std::min(end, m_data.size());
+        if (begin >= end) {
+            return;
+        }
+        for (auto b = begin / block; b <= (end - 1) / block; ++b) {
+            if (!m_dirty_bits.test(b)) {
+                m_dirty_bits.set(b);
+                m_dirty.push_back(b);
+            }
+        }
+    }
+
+    auto mark_all() -> void { mark_dirty(0, m_data.size()); }
+
+    auto set(std::size_t i, T value) -> void {
+        m_data[i] = value;
+        mark_dirty(i, i + 1);
+    }
+
+    /// @brief Copy values over [offset, offset + values.size())
+    auto write(std::size_t offset, std::span<T const> values) -> void {
+        auto n = std::min(values.size(), m_data.size() - std::min(offset, m_data.size()));
+        std::copy_n(values.begin(), n, m_data.begin() + static_cast<std::ptrdiff_t>(offset));
+        mark_dirty(offset, offset + n);
+    }
+
+    /// @brief Writable view of [begin, end), marked dirty up front; writes outside it are not tracked
+    auto modify(std::size_t begin, std::size_t end) -> std::span<T> {
+        end = std::min(end, m_data.size());
+        begin = std::min(begin, end);
+        mark_dirty(begin, end);
+        return std::span<T>(m_data).subspan(begin, end - begin);
+    }
+
+    auto dirty(std::size_t b) const noexcept -> bool { return m_dirty_bits.test(b); }
+
+    /// @brief Blocks written since the last clear_dirty(), in the order they were first written
+    auto dirty_blocks() const noexcept -> std::span<std::size_t const> { return m_dirty; }
+
+    auto clear_dirty() -> void {
+        for (auto b: m_dirty) {
+            m_dirty_bits.set(b, false);
+        }
+        m_dirty.clear();
+    }
+};
+
+
+/// @brief Overflow and underflow checks, NPlus sums and their total over two TrackedArrays, kept up to date
+/// by recomputing only the blocks written since the last refresh.
+///
+/// Per block it caches the two flag counts and the sum of the NPlus results of the lanes neither check
+/// flagged; the per-lane results are kept in results(). Counts are updated by difference. Block sums sit in
+/// the leaves of a fixed-shape pairwise tree and a changed leaf re-adds only its path to the root, so a
+/// refresh costs O(changed blocks * (block + log blocks)) and, because the tree's shape never changes,
+/// total() has the same bits as a from-scratch evaluation however the changes arrived.
+///
+/// Queries refresh first. The object is the single consumer of both arrays' dirty lists.
+template<typename T, OverflowPolicy Policy = OverflowPolicy::Wrap> requires std::is_arithmetic_v<T>
+class IncrementalAddition {
+
+public: /* Public types */
+
+    using result_type = typename NPlus<T, Policy>::result_type;
+
+    static constexpr std::size_t block = TrackedArray<T>::block;
+
+private: /* Private Members */
+
+    /// Dirty blocks above which a refresh is spread over the shared pool
+    static constexpr std::size_t parallel_blocks = 64;
+
+    TrackedArray<T> m_lhs;
+    TrackedArray<T> m_rhs;
+    std::vector<result_type> m_results;
+
+    std::vector<std::size_t> m_overflows;
+    std::vector<std::size_t> m_underflows;
+    std::size_t m_overflow_total = 0;
+    std::size_t m_underflow_total = 0;
+
+    /// Pairwise tree over block sums: node i adds 2i and 2i + 1, leaves start at m_leaves
+    std::vector<result_type> m_tree;
+    std::size_t m_leaves;
+
+private: /* Private Methods */
+
+    /// Integers wrap (as the NPlus Wrap policy would), floating point adds in IEEE
+    static constexpr auto accumulate(result_type a, result_type b) noexcept -> result_type {
+        if constexpr (std::is_floating_point_v<result_type>) {
+            return a + b;
+        } else {
+            using U = typename std::conditional_t<sizeof(result_type) == 16, std::type_identity<unsigned __int128>,
+                                                  std::make_unsigned<result_type>>::type;
+            return static_cast<result_type>(static_cast<U>(static_cast<U>(a) + static_cast<U>(b)));
+        }
+    }
+
+    /// @brief Recompute block b into m_results and its leaf; returns the new (overflow, underflow) counts
+    auto compute(std::size_t b) -> std::pair<std::size_t, std::size_t> {
+        auto begin = b * block;
+        auto len = std::min(block, size() - begin);
+        auto lhs = m_lhs.view().subspan(begin, len);
+        auto rhs = m_rhs.view().subspan(begin, len);
+        auto out = std::span<result_type>(m_results).subspan(begin, len);
+
+        std::array<std::uint8_t, block> up{};
+        std::array<std::uint8_t, block> down{};
+        auto overflows = CpuDispatch::overflow_check<T>(lhs, rhs, std::span<std::uint8_t>(up).first(len));
+        auto underflows = CpuDispatch::underflow_check<T>(lhs, rhs, std::span<std::uint8_t>(down).first(len));
+        CpuDispatch::nplus<T, Policy>(lhs, rhs, out);
+
+        result_type sum{};
+        for (std::size_t i = 0; i < out.size(); ++i) {
+            if (!(up[i] | down[i])) {
+                sum = accumulate(sum, out[i]);
+            }
+        }
+        m_tree[m_leaves + b] = sum;
+        return {overflows, underflows};
+    }
+
+public: /* Constructors */
+
+    IncrementalAddition(std::vector<T> lhs, std::vector<T> rhs)
+            : m_lhs(std::move(lhs)), m_rhs(std::move(rhs)),
+              m_results(std::min(m_lhs.size(), m_rhs.size())),
+              m_overflows(std::min(m_lhs.blocks(), m_rhs.blocks())),
+              m_underflows(m_overflows.size()),
+              m_tree(2 * std::bit_ceil(std::max<std::size_t>(m_overflows.size(), 1))),
+              m_leaves(m_tree.size() / 2) {}
+
+public: /* Public Methods */
+
+    /// @brief The operands; write through set(), write() or modify() so the blocks are tracked
+    auto lhs() noexcept -> TrackedArray<T> & { return m_lhs; }
+
+    auto rhs() noexcept -> TrackedArray<T> & { return m_rhs; }
+
+    auto size() const noexcept -> std::size_t { return m_results.size(); }
+
+    /// @brief Bring every cache up to date with the operands
+    /// @return the number of blocks recomputed
+    auto refresh() -> std::size_t {
+        auto blocks = m_overflows.size();
+        std::vector<std::size_t> dirty;
+        dirty.reserve(m_lhs.dirty_blocks().size() + m_rhs.dirty_blocks().size());
+        for (auto b: m_lhs.dirty_blocks()) {
+            if (b < blocks) {
+                dirty.push_back(b);
+            }
+        }
+        for (auto b: m_rhs.dirty_blocks()) {
+            if (b < blocks && !m_lhs.dirty(b)) {
+                dirty.push_back(b);
+            }
+        }
+        m_lhs.clear_dirty();
+        m_rhs.clear_dirty();
+        if (dirty.empty()) {
+            return 0;
+        }
+
+        std::vector<std::pair<std::size_t, std::size_t>> counts(dirty.size());
+        if (dirty.size() > parallel_blocks) {
+            ThreadPool::shared().for_each_index(dirty.size(), [&](std::size_t i) { counts[i] = compute(dirty[i]); });
+        } else {
+            for (std::size_t i = 0; i < dirty.size(); ++i) {
+                counts[i] = compute(dirty[i]);
+            }
+        }
+
+        for (std::size_t i = 0; i < dirty.size(); ++i) {
+            auto b = dirty[i];
+            m_overflow_total += counts[i].first - m_overflows[b];
+            m_underflow_total += counts[i].second - m_underflows[b];
+            m_overflows[b] = counts[i].first;
+            m_underflows[b] = counts[i].second;
+        }
+
+        /* Re-add the paths above the changed leaves; past a quarter of the leaves a full rebuild is cheaper */
+        if (dirty.size() * 4 > blocks) {
+            for (auto node = m_leaves - 1; node >= 1; --node) {
+                m_tree[node] = accumulate(m_tree[2 * node], m_tree[2 * node + 1]);
+            }
+        } else {
+            for (auto b: dirty) {
+                for (auto node = (m_leaves + b) / 2; node >= 1; node /= 2) {
+                    m_tree[node] = accumulate(m_tree[2 * node], m_tree[2 * node + 1]);
+                }
+            }
+        }
+        return dirty.size();
+    }
+
+    /// @brief Lanes flagged by CpuDispatch::overflow_check
+    auto overflows() -> std::size_t {
+        refresh();
+        return m_overflow_total;
+    }
+
+    /// @brief Lanes flagged by CpuDispatch::underflow_check
+    auto underflows() -> std::size_t {
+        refresh();
+        return m_underflow_total;
+    }
+
+    /// @brief NPlus<T, Policy>(lhs[i], rhs[i]) for every lane
+    auto results() -> std::span<result_type const> {
+        refresh();
+        return m_results;
+    }
+
+    /// @brief Sum of the results of the lanes neither check flagged
+    auto total() -> result_type {
+        refresh();
+        return m_tree[1];
+    }
+};
+
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef THREADED_BENCH_TCC
+#define THREADED_BENCH_TCC
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+/// Shared helpers of the bench/ executables: argument parsing, best-of-n timing, one JSON object per result
+/// line (in the style of Instrumentation::to_json) and hardware event counts through perf_event_open.
+namespace Bench {
+
+    /// @brief argv[index] as a count ("1e8" and "100000000" both work), or fallback when it is absent
+    inline auto count_arg(int argc, char **argv, int index, std::size_t fallback) -> std::size_t {
+        if (index >= argc) {
+            return fallback;
+        }
+        auto value = std::strtod(argv[index], nullptr);
+        return value >= 1 ? static_cast<std::size_t>(value) : fallback;
+    }
+
+    /// @brief Best wall time of repeats runs of fn, in seconds; setup runs before each one, untimed
+    template<typename Setup, typename F>
+    auto best_seconds(std::size_t repeats, Setup &&setup, F &&fn) -> double {
+        auto best = std::chrono::steady_clock::duration::max();
+        for (std::size_t r = 0; r < std::max<std::size_t>(repeats, 1); ++r) {
+            setup();
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            best = std::min(best, std::chrono::steady_clock::now() - start);
+        }
+        return std::chrono::duration<double>(best).count();
+    }
+
+    template<typename F>
+    auto best_seconds(std::size_t repeats, F &&fn) -> double {
+        return best_seconds(repeats, [] {}, std::forward<F>(fn));
+    }
+
+    /// @brief The p-th percentile (0 to 100, nearest rank) of samples
+    template<typename T>
+    auto percentile(std::vector<T> samples, double p) -> T {
+        if (samples.empty()) {
+            return T{};
+        }
+        auto rank = static_cast<std::size_t>(p / 100 * static_cast<double>(samples.size() - 1) + 0.5);
+        std::ranges::nth_element(samples, samples.begin() + static_cast<std::ptrdiff_t>(rank));
+        return samples[rank];
+    }
+
+    /// @brief One result line: {"bench": name, key: value, ...}
+    class Row {
+        std::string m_json;
+
+    public:
+        explicit Row(std::string_view name) : m_json("{\"bench\": \"" + std::string(name) + "\"") {}
+
+        auto add(std::string_view key, std::string_view value) -> Row & {
+            m_json += ", \"" + std::string(key) + "\": \"" + std::string(value) + "\"";
+            return *this;
+        }
+
+        auto add(std::string_view key, char const *value) -> Row & { return add(key, std::string_view(value)); }
+
+        auto add(std::string_view key, bool value) -> Row & {
+            m_json += ", \"" + std::string(key) + "\": " + (value ? "true" : "false");
+            return *this;
+        }
+
+        template<typename N> requires std::is_arithmetic_v<N> && (!std::is_same_v<N, bool>)
+        auto add(std::string_view key, N value) -> Row & {
+            m_json += ", \"" + std::string(key) + "\": " + std::to_string(value);
+            return *this;
+        }
+
+        /// @brief Optional counts print as null where the counter could not be read
+        auto add(std::string_view key, std::optional<std::uint64_t> value) -> Row & {
+            m_json += ", \"" + std::string(key) + "\": " + (value ? std::to_string(*value) : std::string("null"));
+            return *this;
+        }
+
+        ~Row() { std::printf("%s}\n", m_json.c_str()); }
+    };
+
+    /// @brief n values spread over the whole range of T, identical for identical seeds
+    template<typename T>
+    auto random_values(std::size_t n, std::uint64_t seed = 1) -> std::vector<T> {
+        std::mt19937_64 rng(seed);
+        std::vector<T> values(n);
+        if constexpr (std::is_floating_point_v<T>) {
+            std::uniform_real_distribution<T> dist(T{-1e6}, T{1e6});
+            std::ranges::generate(values, [&] { return dist(rng); });
+        } else {
+            std::ranges::generate(values, [&] { return static_cast<T>(rng()); });
+        }
+        return values;
+    }
+
+    /// @brief Count of one hardware event on the calling thread between start() and stop().
+    ///
+    /// stop() returns nullopt where the event cannot be opened (not Linux, no PMU in a VM, or
+    /// perf_event_paranoid forbids it), so benchmarks still report their timings.
+    class PerfCounter {
+        int m_fd = -1;
+
+    public:
+        PerfCounter(std::uint32_t type, std::uint64_t config) {
+#if defined(__linux__)
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.inherit = 1;
+            m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+            (void) type;
+            (void) config;
+#endif
+        }
+
+        PerfCounter(PerfCounter const &) = delete;
+
+        PerfCounter &operator=(PerfCounter const &) = delete;
+
+        ~PerfCounter() {
+#if defined(__linux__)
+            if (m_fd >= 0) {
+                close(m_fd);
+            }
+#endif
+        }
+
+        /// Last-level cache misses
+        static auto cache_misses() -> PerfCounter { return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES}; }
+
+        /// Data TLB load misses
+        static auto dtlb_misses() -> PerfCounter {
+            return {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+        }
+
+        auto start() -> void {
+#if defined(__linux__)
+            if (m_fd >= 0) {
+                ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        auto stop() -> std::optional<std::uint64_t> {
+#if defined(__linux__)
+            if (m_fd >= 0) {
+                ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+                std::uint64_t count = 0;
+                if (read(m_fd, &count, sizeof(count)) == static_cast<ssize_t>(sizeof(count))) {
+                    return count;
+                }
+            }
+#endif
+            return std::nullopt;
+        }
+    };
+}
+
+
+#endif
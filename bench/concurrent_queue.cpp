@@ -0,0 +1,122 @@
+/* ConcurrentQueue (MPMC, and SPSC for one producer and one consumer) against a mutex-protected queue, for 1 to
+   32 producers and as many consumers. Usage: bench_concurrent_queue [ops = 1e7] [capacity = 4096] */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ConcurrentQueue.tcc"
+#include "bench/Bench.tcc"
+
+
+/// @brief The baseline: a bounded std::deque behind one mutex, with the push/pop_batch/close interface of
+/// ConcurrentQueue
+template<typename T>
+class MutexQueue {
+    std::mutex m_mutex;
+    std::condition_variable m_not_empty;
+    std::condition_variable m_not_full;
+    std::deque<T> m_items;
+    std::size_t m_capacity;
+    bool m_closed = false;
+
+public:
+    explicit MutexQueue(std::size_t capacity) : m_capacity(capacity) {}
+
+    auto push(T value) -> void {
+        std::unique_lock lock(m_mutex);
+        m_not_full.wait(lock, [&] { return m_items.size() < m_capacity; });
+        m_items.push_back(std::move(value));
+        lock.unlock();
+        m_not_empty.notify_one();
+    }
+
+    auto pop_batch(std::span<T> out) -> std::size_t {
+        std::unique_lock lock(m_mutex);
+        m_not_empty.wait(lock, [&] { return !m_items.empty() || m_closed; });
+        std::size_t n = 0;
+        for (; n < out.size() && !m_items.empty(); ++n) {
+            out[n] = std::move(m_items.front());
+            m_items.pop_front();
+        }
+        lock.unlock();
+        m_not_full.notify_all();
+        return n;
+    }
+
+    auto close() -> void {
+        {
+            std::lock_guard lock(m_mutex);
+            m_closed = true;
+        }
+        m_not_empty.notify_all();
+    }
+};
+
+
+/// @brief Push ops values through queue from producers threads to consumers threads
+/// @return true if every value arrived exactly once (checked through the sum)
+template<typename Queue>
+auto run(std::string_view name, std::size_t producers, std::size_t consumers, std::size_t ops,
+         std::size_t capacity) -> bool {
+    Queue queue(capacity);
+    std::atomic<std::uint64_t> received{0};
+    std::vector<std::thread> threads;
+
+    auto seconds = Bench::best_seconds(1, [&] {
+        for (std::size_t c = 0; c < consumers; ++c) {
+            threads.emplace_back([&] {
+                std::uint64_t local = 0;
+                std::uint64_t batch[64];
+                while (auto n = queue.pop_batch(std::span<std::uint64_t>(batch))) {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        local += batch[i];
+                    }
+                }
+                received.fetch_add(local, std::memory_order_relaxed);
+            });
+        }
+
+        std::vector<std::thread> senders;
+        for (std::size_t p = 0; p < producers; ++p) {
+            senders.emplace_back([&, p] {
+                for (auto i = ops * p / producers; i < ops * (p + 1) / producers; ++i) {
+                    queue.push(i + 1);
+                }
+            });
+        }
+        for (auto &t: senders) {
+            t.join();
+        }
+        queue.close();
+        for (auto &t: threads) {
+            t.join();
+        }
+    });
+
+    bool exact = received.load() == ops * (ops + 1) / 2;
+    Bench::Row("concurrent_queue").add("queue", name).add("producers", producers).add("consumers", consumers)
+            .add("ops", ops).add("seconds", seconds).add("ops_per_second", static_cast<double>(ops) / seconds)
+            .add("exact", exact);
+    return exact;
+}
+
+auto main(int argc, char **argv) -> int {
+    auto ops = Bench::count_arg(argc, argv, 1, 10'000'000);
+    auto capacity = Bench::count_arg(argc, argv, 2, 4096);
+
+    bool ok = run<ConcurrentQueue<std::uint64_t, QueueMode::SPSC>>("spsc", 1, 1, ops, capacity);
+    for (std::size_t threads: {1, 2, 4, 8, 16, 32}) {
+        ok &= run<ConcurrentQueue<std::uint64_t>>("mpmc", threads, threads, ops, capacity);
+        ok &= run<MutexQueue<std::uint64_t>>("mutex", threads, threads, ops, capacity);
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
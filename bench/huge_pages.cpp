@@ -0,0 +1,103 @@
+/* Throughput and data TLB misses of HugeBuffer on 2 MiB and 1 GiB HugePageResources against an array from
+   the default allocator: first touch, a sequential sum and a random gather over the same number of elements.
+   TLB counts are null where perf_event_open is unavailable.
+   Usage: bench_huge_pages [bytes = 1 GiB, rounded down to a power of two] [gathers = 1e8] */
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "HugePageResource.tcc"
+#include "bench/Bench.tcc"
+
+
+/// @brief Time and dTLB misses of one run of fn
+template<typename F>
+auto measure(F &&fn) -> std::pair<double, std::optional<std::uint64_t>> {
+    auto misses = Bench::PerfCounter::dtlb_misses();
+    misses.start();
+    auto seconds = Bench::best_seconds(1, fn);
+    return {seconds, misses.stop()};
+}
+
+auto run(std::string_view name, std::string_view backing, std::span<std::uint64_t> data, std::size_t gathers)
+-> std::uint64_t {
+    auto n = data.size();
+    auto [touch_seconds, touch_misses] = measure([&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            data[i] = i;
+        }
+    });
+
+    std::uint64_t sequential = 0;
+    auto [sum_seconds, sum_misses] = measure([&] {
+        for (auto v: data) {
+            sequential += v;
+        }
+    });
+
+    /* Independent loads at hashed indices: every one is likely a TLB miss on 4 KiB pages */
+    std::uint64_t gathered = 0;
+    auto mask = n - 1;
+    auto [gather_seconds, gather_misses] = measure([&] {
+        for (std::uint64_t i = 0; i < gathers; ++i) {
+            gathered += data[(i * 0x9E3779B97F4A7C15ull >> 20) & mask];
+        }
+    });
+
+    auto gb = static_cast<double>(n * sizeof(std::uint64_t)) / 1e9;
+    Bench::Row("huge_pages").add("buffer", name).add("backing", backing).add("bytes", n * sizeof(std::uint64_t))
+            .add("touch_gb_per_second", gb / touch_seconds).add("touch_dtlb_misses", touch_misses)
+            .add("sum_gb_per_second", gb / sum_seconds).add("sum_dtlb_misses", sum_misses)
+            .add("gathers_per_second", static_cast<double>(gathers) / gather_seconds)
+            .add("gather_dtlb_misses", gather_misses);
+    return sequential + gathered;
+}
+
+/// @brief Which backing the last mapping of resource got, from the change in its stats
+auto backing(HugePageResource::Stats const &before, HugePageResource::Stats const &after) -> std::string {
+    if (after.hugetlb > before.hugetlb) {
+        return "hugetlb";
+    }
+    if (after.transparent > before.transparent) {
+        return "transparent";
+    }
+    return after.plain > before.plain ? "plain" : "upstream";
+}
+
+auto main(int argc, char **argv) -> int {
+    auto bytes = std::bit_floor(std::max<std::size_t>(Bench::count_arg(argc, argv, 1, std::size_t{1} << 30), 4096));
+    auto gathers = Bench::count_arg(argc, argv, 2, 100'000'000);
+    auto n = bytes / sizeof(std::uint64_t);
+
+    std::uint64_t checks[3];
+    {
+        /* Left uninitialized, like HugeBuffer, so the first touch is timed for both */
+        auto data = std::make_unique_for_overwrite<std::uint64_t[]>(n);
+        checks[0] = run("default_allocator", "default", {data.get(), n}, gathers);
+    }
+    {
+        HugePageResource resource(PageSize::Huge2M);
+        auto before = resource.stats();
+        HugeBuffer<std::uint64_t> data(n, resource);
+        checks[1] = run("huge_buffer_2m", backing(before, resource.stats()), data, gathers);
+    }
+    {
+        HugePageResource resource(PageSize::Huge1G);
+        auto before = resource.stats();
+        HugeBuffer<std::uint64_t> data(n, resource);
+        checks[2] = run("huge_buffer_1g", backing(before, resource.stats()), data, gathers);
+    }
+
+    bool same = checks[0] == checks[1] && checks[1] == checks[2];
+    Bench::Row("huge_pages").add("results_match", same);
+    return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
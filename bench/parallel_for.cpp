@@ -0,0 +1,78 @@
+/* ThreadPool::parallel_for with automatic grain against a fixed static split and std::for_each(par), for cheap
+   and heavy uniform per-element costs and for a skewed cost that grows toward the end of the range.
+   Usage: bench_parallel_for [n = 1e7] [repeats = 5] */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <execution>
+#include <functional>
+#include <ranges>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ThreadPool.tcc"
+#include "bench/Bench.tcc"
+
+
+/// @brief iterations dependent multiply-adds on x; the compiler cannot shortcut the chain
+auto work(double x, std::size_t iterations) -> double {
+    for (std::size_t k = 0; k < iterations; ++k) {
+        x = x * 0.999999 + 1e-7;
+    }
+    return x;
+}
+
+auto run(std::string_view shape, std::size_t n, std::size_t repeats, ThreadPool &pool,
+         std::function<std::size_t(std::size_t)> const &cost) -> bool {
+    std::vector<std::size_t> iterations(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        iterations[i] = cost(i);
+    }
+    std::vector<double> out(n), expected(n);
+    auto body = [&](std::size_t i) { out[i] = work(static_cast<double>(i), iterations[i]); };
+    auto indices = std::views::iota(std::size_t{0}, n);
+
+    ParallelForStats stats;
+    auto auto_seconds = Bench::best_seconds(repeats, [&] { stats = pool.parallel_for(indices, body); });
+    std::ranges::copy(out, expected.begin());
+
+    /* One chunk per thread: what a static schedule does */
+    auto static_seconds = Bench::best_seconds(repeats, [&] {
+        pool.parallel_for(indices, body, {.grain = (n + pool.concurrency() - 1) / pool.concurrency()});
+    });
+    bool same = out == expected;
+
+    auto par_seconds = Bench::best_seconds(repeats, [&] {
+        std::for_each(std::execution::par, indices.begin(), indices.end(), body);
+    });
+    same &= out == expected;
+
+    Bench::Row("parallel_for").add("cost", shape).add("n", n).add("threads", pool.concurrency())
+            .add("auto_seconds", auto_seconds).add("static_seconds", static_seconds)
+            .add("std_for_each_par_seconds", par_seconds)
+            .add("chunks", stats.chunks).add("steals", stats.steals).add("participants", stats.participants)
+            .add("ns_per_element", stats.ns_per_element).add("final_grain", stats.final_grain)
+            .add("results_match", same);
+    return same;
+}
+
+auto main(int argc, char **argv) -> int {
+    auto n = Bench::count_arg(argc, argv, 1, 10'000'000);
+    auto repeats = Bench::count_arg(argc, argv, 2, 5);
+    ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()) - 1);
+
+    bool ok = run("uniform_cheap", n, repeats, pool, [](std::size_t) { return 1; });
+    ok &= run("uniform_heavy", n / 100, repeats, pool, [](std::size_t) { return 1000; });
+
+    /* The last 1% of the elements cost 1000 times the rest */
+    ok &= run("skewed", n / 10, repeats, pool, [m = n / 10](std::size_t i) -> std::size_t {
+        return i >= m - m / 100 ? 1000 : 1;
+    });
+
+    /* Cost grows linearly from 0 to 200 iterations over the range */
+    ok &= run("linear", n / 10, repeats, pool, [m = n / 10](std::size_t i) { return 200 * i / m; });
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
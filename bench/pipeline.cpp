@@ -0,0 +1,85 @@
+/* Fused against staged Pipeline schedules at DRAM-scale sizes: classify infinities, check the range, add,
+   then either reduce to a sum or materialize the values and flags.
+   Usage: bench_pipeline [n = 5e7] [repeats = 3] */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "Pipeline.tcc"
+#include "bench/Bench.tcc"
+
+
+/// @brief The job the pipeline was built for; integers have no infinities to classify
+template<typename T>
+auto chain(std::span<T const> lhs, std::span<T const> rhs, PipelineSchedule schedule) {
+    auto p = pipeline<T>(lhs, rhs, {.schedule = schedule});
+    if constexpr (std::is_floating_point_v<T>) {
+        return p.template classify<Predicates::PositiveInfinityQ<T>>()
+                .template classify<Predicates::NegativeInfinityQ<T>>().check_range().template add<>();
+    } else {
+        return p.check_range().template add<>();
+    }
+}
+
+template<typename T>
+auto run(std::string_view type, std::size_t n, std::size_t repeats) -> bool {
+    auto lhs = Bench::random_values<T>(n, 1);
+    auto rhs = Bench::random_values<T>(n, 2);
+
+    /* Every 1000th lane is infinite or overflows, so the flags are not all zero */
+    for (std::size_t i = 0; i < n; i += 1000) {
+        if constexpr (std::is_floating_point_v<T>) {
+            lhs[i] = (i / 1000) % 2 ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+            rhs[i] = std::numeric_limits<T>::max();
+        } else {
+            lhs[i] = rhs[i] = std::numeric_limits<T>::max();
+        }
+    }
+
+    using V = typename decltype(chain<T>(lhs, rhs, PipelineSchedule::Fused))::value_type;
+    std::vector<V> values(n);
+    std::vector<std::uint8_t> flags(n);
+
+    bool same = true;
+    PipelineResult<V> sums[2]{};
+    std::size_t flagged[2]{};
+    double sum_seconds[2], materialize_seconds[2];
+    for (auto schedule: {PipelineSchedule::Fused, PipelineSchedule::Staged}) {
+        auto s = static_cast<std::size_t>(schedule);
+        auto p = chain<T>(lhs, rhs, schedule);
+        sum_seconds[s] = Bench::best_seconds(repeats, [&] { sums[s] = p.sum(); });
+        materialize_seconds[s] = Bench::best_seconds(repeats, [&] { flagged[s] = p.materialize(values, flags); });
+    }
+
+    /* Same tiles, same order: the schedules must agree exactly */
+    same &= sums[0].value == sums[1].value && sums[0].flagged == sums[1].flagged && flagged[0] == flagged[1];
+    same &= sums[0].flagged > 0;
+
+    auto bytes = static_cast<double>(2 * n * sizeof(T));
+    Bench::Row("pipeline").add("type", type).add("n", n).add("input_bytes", 2 * n * sizeof(T))
+            .add("flagged", sums[0].flagged)
+            .add("sum_fused_seconds", sum_seconds[0]).add("sum_staged_seconds", sum_seconds[1])
+            .add("sum_speedup", sum_seconds[1] / sum_seconds[0])
+            .add("sum_fused_gb_per_second", bytes / 1e9 / sum_seconds[0])
+            .add("materialize_fused_seconds", materialize_seconds[0])
+            .add("materialize_staged_seconds", materialize_seconds[1])
+            .add("materialize_speedup", materialize_seconds[1] / materialize_seconds[0])
+            .add("results_match", same);
+    return same;
+}
+
+auto main(int argc, char **argv) -> int {
+    auto n = Bench::count_arg(argc, argv, 1, 50'000'000);
+    auto repeats = Bench::count_arg(argc, argv, 2, 3);
+
+    bool ok = run<double>("double", n, repeats);
+    ok &= run<std::int64_t>("int64", n, repeats);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
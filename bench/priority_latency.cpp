@@ -0,0 +1,89 @@
+/* Queueing latency of ThreadPool tasks per Priority, on an idle pool and on one saturated with low-priority
+   work: every worker keeps running Low tasks that resubmit themselves, while probes of each priority are
+   submitted at a steady rate. Usage: bench_priority_latency [probes = 3000] [low task us = 200] */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ThreadPool.tcc"
+#include "bench/Bench.tcc"
+
+
+using Clock = std::chrono::steady_clock;
+
+auto spin(std::chrono::microseconds duration) -> void {
+    auto until = Clock::now() + duration;
+    while (Clock::now() < until) {
+    }
+}
+
+auto run(bool saturated, std::size_t probes, std::chrono::microseconds low_task) -> void {
+    constexpr std::array priorities{Priority::High, Priority::Normal, Priority::Low};
+    constexpr std::array<std::string_view, 3> names{"high", "normal", "low"};
+
+    std::atomic<bool> stop{false};
+    std::function<void()> filler;
+
+    /* Declared after filler: the destructor drains the queued fillers, which no longer resubmit once stopped */
+    ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()) - 1);
+
+    if (saturated) {
+        filler = [&] {
+            spin(low_task);
+            if (!stop.load(std::memory_order_relaxed)) {
+                pool.submit(filler, Priority::Low);
+            }
+        };
+        for (std::size_t w = 0; w < 2 * pool.concurrency(); ++w) {
+            pool.submit(filler, Priority::Low);
+        }
+    }
+
+    std::array<std::vector<double>, priorities.size()> samples;
+    for (auto &s: samples) {
+        s.assign(probes / priorities.size() + 1, 0);
+    }
+    std::atomic<std::size_t> done{0};
+
+    for (std::size_t i = 0; i < probes; ++i) {
+        auto p = i % priorities.size();
+        auto slot = &samples[p][i / priorities.size()];
+        auto submitted = Clock::now();
+        pool.submit([slot, submitted, &done] {
+            *slot = std::chrono::duration<double, std::micro>(Clock::now() - submitted).count();
+            done.fetch_add(1, std::memory_order_release);
+        }, priorities[p]);
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    while (done.load(std::memory_order_acquire) < probes) {
+        std::this_thread::yield();
+    }
+    stop.store(true, std::memory_order_relaxed);
+
+    for (std::size_t p = 0; p < priorities.size(); ++p) {
+        auto count = (probes + priorities.size() - 1 - p) / priorities.size();
+        samples[p].resize(count);
+        Bench::Row("priority_latency").add("load", saturated ? "saturated" : "idle").add("priority", names[p])
+                .add("threads", pool.concurrency()).add("probes", count)
+                .add("p50_us", Bench::percentile(samples[p], 50)).add("p90_us", Bench::percentile(samples[p], 90))
+                .add("p99_us", Bench::percentile(samples[p], 99))
+                .add("max_us", Bench::percentile(samples[p], 100));
+    }
+}
+
+auto main(int argc, char **argv) -> int {
+    auto probes = Bench::count_arg(argc, argv, 1, 3000);
+    auto low_task = std::chrono::microseconds(Bench::count_arg(argc, argv, 2, 200));
+
+    run(false, probes, low_task);
+    run(true, probes, low_task);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,113 @@
+/* Cache misses and time of single- and two-field passes over RadixDataArray against a std::vector of the
+   32-byte RadixData layout (four size_t-wide fields). Counts are null where perf_event_open is unavailable.
+   Usage: bench_radix_data_array [n = 1e7] [repeats = 5] */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "RadixDataArray.tcc"
+#include "bench/Bench.tcc"
+
+
+/// The array-of-structs layout of RadixData<std::uint64_t> in main.cpp
+struct RadixDataFields {
+    std::uint64_t data = 0;
+    std::size_t radix = 2;
+    std::size_t mantissa = 0;
+    std::size_t exponent = 0;
+};
+
+static_assert(sizeof(RadixDataFields) == 32);
+
+
+/// @brief Best time of fn and the cache misses of that same run
+template<typename F>
+auto measure(std::size_t repeats, F &&fn) -> std::pair<double, std::optional<std::uint64_t>> {
+    auto misses = Bench::PerfCounter::cache_misses();
+    double best = std::numeric_limits<double>::max();
+    std::optional<std::uint64_t> best_misses;
+    for (std::size_t r = 0; r < repeats; ++r) {
+        misses.start();
+        auto seconds = Bench::best_seconds(1, fn);
+        auto count = misses.stop();
+        if (seconds < best) {
+            best = seconds;
+            best_misses = count;
+        }
+    }
+    return {best, best_misses};
+}
+
+template<typename Soa, typename Aos>
+auto compare(std::string_view pass, std::size_t n, std::size_t repeats, Soa &&soa, Aos &&aos) -> void {
+    auto [soa_seconds, soa_misses] = measure(repeats, soa);
+    auto [aos_seconds, aos_misses] = measure(repeats, aos);
+    Bench::Row("radix_data_array").add("pass", pass).add("n", n)
+            .add("soa_seconds", soa_seconds).add("soa_cache_misses", soa_misses)
+            .add("vector_seconds", aos_seconds).add("vector_cache_misses", aos_misses)
+            .add("speedup", aos_seconds / soa_seconds);
+}
+
+auto main(int argc, char **argv) -> int {
+    auto n = Bench::count_arg(argc, argv, 1, 10'000'000);
+    auto repeats = Bench::count_arg(argc, argv, 2, 5);
+
+    using Array = RadixDataArray<std::uint64_t, std::uint32_t, std::int32_t>;
+    auto const values = Bench::random_values<std::uint32_t>(n);
+
+    Array soa;
+    std::vector<RadixDataFields> aos(n);
+    soa.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        auto exponent = static_cast<std::int32_t>(values[i] % 64) - 32;
+        soa.push_back({values[i], 10, values[i], exponent});
+        aos[i] = {values[i], 10, values[i], static_cast<std::size_t>(exponent)};
+    }
+
+    /* One field: rescale every exponent */
+    compare("rescale_exponents", n, repeats, [&] { soa.rescale_exponents(1); }, [&] {
+        for (auto &r: aos) {
+            r.exponent += 1;
+        }
+    });
+
+    /* One field: overwrite every radix */
+    compare("fill_radix", n, repeats, [&] { soa.fill_radix(16); }, [&] {
+        for (auto &r: aos) {
+            r.radix = 16;
+        }
+    });
+
+    /* Two fields: read mantissa and exponent together */
+    std::uint64_t soa_total = 0, aos_total = 0;
+    compare("mantissa_exponent_sum", n, repeats, [&] {
+        auto mantissas = soa.mantissas();
+        auto exponents = soa.exponents();
+        std::uint64_t total = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            total += mantissas[i] + static_cast<std::uint64_t>(exponents[i]);
+        }
+        soa_total = total;
+    }, [&] {
+        std::uint64_t total = 0;
+        for (auto const &r: aos) {
+            total += r.mantissa + r.exponent;
+        }
+        aos_total = total;
+    });
+
+    /* The bulk radix conversion has no counterpart on the plain vector; report its rate alone */
+    auto [convert_seconds, convert_misses] = measure(1, [&] { soa.convert_radix(2); });
+    Bench::Row("radix_data_array").add("pass", "convert_radix").add("n", n).add("soa_seconds", convert_seconds)
+            .add("soa_cache_misses", convert_misses)
+            .add("records_per_second", static_cast<double>(n) / convert_seconds);
+
+    bool same = soa_total == aos_total;
+    Bench::Row("radix_data_array").add("n", n).add("results_match", same);
+    return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,94 @@
+/* RadixParse against std::from_chars in the radices 2, 8, 10 and 16, one string at a time and over a
+   newline-delimited buffer. Usage: bench_radix_parse [n = 1e7] [repeats = 5] */
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "RadixParse.tcc"
+#include "bench/Bench.tcc"
+
+
+template<typename T>
+auto run(std::string_view type, std::size_t radix, std::size_t n, std::size_t repeats) -> bool {
+    auto const input = Bench::random_values<T>(n);
+
+    /* The batch buffer, plus every line as its own view for the single-string loops */
+    std::string buffer;
+    std::vector<std::string_view> lines(n);
+    std::vector<std::size_t> offsets(n + 1);
+    for (std::size_t i = 0; i < n; ++i) {
+        char text[72];
+        auto [end, ec] = std::to_chars(text, text + sizeof(text), input[i], static_cast<int>(radix));
+        offsets[i] = buffer.size();
+        buffer.append(text, end).push_back('\n');
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        lines[i] = std::string_view(buffer).substr(offsets[i], buffer.find('\n', offsets[i]) - offsets[i]);
+    }
+
+    std::vector<T> parsed(n), expected(n);
+    auto single_seconds = Bench::best_seconds(repeats, [&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            RadixParse<T>{}(lines[i], radix, parsed[i]);
+        }
+    });
+    auto from_chars_seconds = Bench::best_seconds(repeats, [&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            std::from_chars(lines[i].data(), lines[i].data() + lines[i].size(), expected[i], static_cast<int>(radix));
+        }
+    });
+
+    std::vector<T> values;
+    std::vector<ParseStatus> status;
+    std::size_t failures = 0;
+    auto batch_seconds = Bench::best_seconds(repeats, [&] {
+        values.clear();
+        status.clear();
+        values.reserve(n);
+        status.reserve(n);
+    }, [&] {
+        failures = RadixParse<T>::batch(buffer, radix, values, status);
+    });
+
+    /* The same batch done with from_chars: find each newline, parse the line */
+    std::vector<T> batch_expected;
+    auto from_chars_batch_seconds = Bench::best_seconds(repeats, [&] {
+        batch_expected.clear();
+        batch_expected.reserve(n);
+    }, [&] {
+        char const *p = buffer.data(), *last = buffer.data() + buffer.size();
+        while (p < last) {
+            T value{};
+            auto [end, ec] = std::from_chars(p, last, value, static_cast<int>(radix));
+            batch_expected.push_back(value);
+            p = end + 1;
+        }
+    });
+
+    bool same = parsed == input && expected == input && values == input && batch_expected == input && failures == 0;
+    auto mb = static_cast<double>(buffer.size()) / 1e6;
+    Bench::Row("radix_parse").add("type", type).add("radix", radix).add("n", n).add("bytes", buffer.size())
+            .add("single_mb_per_second", mb / single_seconds)
+            .add("from_chars_mb_per_second", mb / from_chars_seconds)
+            .add("batch_mb_per_second", mb / batch_seconds)
+            .add("from_chars_batch_mb_per_second", mb / from_chars_batch_seconds)
+            .add("batch_speedup", from_chars_batch_seconds / batch_seconds).add("parsed", same);
+    return same;
+}
+
+auto main(int argc, char **argv) -> int {
+    auto n = Bench::count_arg(argc, argv, 1, 10'000'000);
+    auto repeats = Bench::count_arg(argc, argv, 2, 5);
+
+    bool ok = true;
+    for (std::size_t radix: {2, 8, 10, 16}) {
+        ok &= run<std::uint32_t>("uint32", radix, n, repeats);
+        ok &= run<std::int64_t>("int64", radix, n, repeats);
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,81 @@
+/* RadixSort against std::sort(std::execution::par) on 32/64-bit integer and float keys, key-only and
+   key+payload. Usage: bench_radix_sort [n = 1e8] [repeats = 3] */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <execution>
+#include <numeric>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "RadixSort.tcc"
+#include "bench/Bench.tcc"
+
+
+template<typename Key>
+auto keys_only(std::string_view type, std::size_t n, std::size_t repeats) -> bool {
+    auto const input = Bench::random_values<Key>(n);
+    std::vector<Key> radix, baseline;
+
+    auto radix_seconds = Bench::best_seconds(repeats, [&] { radix = input; }, [&] {
+        RadixSort<Key>{}(std::span<Key>(radix));
+    });
+    auto baseline_seconds = Bench::best_seconds(repeats, [&] { baseline = input; }, [&] {
+        std::sort(std::execution::par, baseline.begin(), baseline.end());
+    });
+
+    bool same = radix == baseline;
+    Bench::Row("radix_sort").add("key", type).add("payload", false).add("n", n)
+            .add("radix_seconds", radix_seconds).add("std_sort_par_seconds", baseline_seconds)
+            .add("speedup", baseline_seconds / radix_seconds).add("sorted", same);
+    return same;
+}
+
+/* The baseline sorts (key, payload) pairs on the key, which is the layout a caller without a payload-aware sort
+   would build; std::stable_sort keeps it comparable to the stable radix sort */
+template<typename Key>
+auto with_payload(std::string_view type, std::size_t n, std::size_t repeats) -> bool {
+    auto const input = Bench::random_values<Key>(n);
+    std::vector<Key> keys;
+    std::vector<std::uint32_t> payload(n);
+    std::vector<std::pair<Key, std::uint32_t>> pairs(n);
+
+    auto radix_seconds = Bench::best_seconds(repeats, [&] {
+        keys = input;
+        std::iota(payload.begin(), payload.end(), 0u);
+    }, [&] {
+        RadixSort<Key>{}(std::span<Key>(keys), std::span<std::uint32_t>(payload));
+    });
+    auto baseline_seconds = Bench::best_seconds(repeats, [&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            pairs[i] = {input[i], static_cast<std::uint32_t>(i)};
+        }
+    }, [&] {
+        std::stable_sort(std::execution::par, pairs.begin(), pairs.end(),
+                         [](auto const &lhs, auto const &rhs) { return lhs.first < rhs.first; });
+    });
+
+    bool same = true;
+    for (std::size_t i = 0; i < n && same; ++i) {
+        same = keys[i] == pairs[i].first && payload[i] == pairs[i].second;
+    }
+    Bench::Row("radix_sort").add("key", type).add("payload", true).add("n", n)
+            .add("radix_seconds", radix_seconds).add("std_sort_par_seconds", baseline_seconds)
+            .add("speedup", baseline_seconds / radix_seconds).add("sorted", same);
+    return same;
+}
+
+auto main(int argc, char **argv) -> int {
+    auto n = Bench::count_arg(argc, argv, 1, 100'000'000);
+    auto repeats = Bench::count_arg(argc, argv, 2, 3);
+
+    bool ok = keys_only<std::uint32_t>("uint32", n, repeats);
+    ok &= keys_only<std::uint64_t>("uint64", n, repeats);
+    ok &= keys_only<float>("float", n, repeats);
+    ok &= with_payload<std::uint64_t>("uint64", n, repeats);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
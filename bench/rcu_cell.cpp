@@ -0,0 +1,144 @@
+/* Read throughput of RcuCell while a writer swaps the value as fast as it can, against a std::shared_mutex
+   and a std::atomic<std::shared_ptr>. Doubles as a stress test: every read checks it saw one whole version,
+   and after Epoch::synchronize() exactly one value per cell may be alive.
+   Usage: bench_rcu_cell [milliseconds per run = 500] */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "EpochReclamation.tcc"
+#include "bench/Bench.tcc"
+
+
+/// @brief Stand-in for a large configuration object; every field holds the version it was written with
+struct Config {
+    static inline std::atomic<std::int64_t> alive{0};
+
+    std::array<std::uint64_t, 32> fields{};
+
+    explicit Config(std::uint64_t version = 0) { fields.fill(version); ++alive; }
+
+    Config(Config const &other) : fields(other.fields) { ++alive; }
+
+    Config(Config &&other) noexcept: fields(other.fields) { ++alive; }
+
+    Config &operator=(Config const &) = default;
+
+    ~Config() { --alive; }
+
+    /// @brief True if every field belongs to the same version
+    auto whole() const -> bool {
+        return std::ranges::all_of(fields, [&](auto f) { return f == fields.front(); });
+    }
+};
+
+class RcuAdapter {
+    RcuCell<Config> m_cell{Config(0)};
+
+public:
+    auto whole() const -> bool { return m_cell.read()->whole(); }
+
+    auto store(std::uint64_t version) -> void { m_cell.store(Config(version)); }
+};
+
+class SharedMutexAdapter {
+    mutable std::shared_mutex m_mutex;
+    Config m_value{0};
+
+public:
+    auto whole() const -> bool {
+        std::shared_lock lock(m_mutex);
+        return m_value.whole();
+    }
+
+    auto store(std::uint64_t version) -> void {
+        Config fresh(version);
+        std::unique_lock lock(m_mutex);
+        m_value = fresh;
+    }
+};
+
+class AtomicSharedPtrAdapter {
+    std::atomic<std::shared_ptr<Config const>> m_value{std::make_shared<Config const>(0)};
+
+public:
+    auto whole() const -> bool { return m_value.load(std::memory_order_acquire)->whole(); }
+
+    auto store(std::uint64_t version) -> void {
+        m_value.store(std::make_shared<Config const>(version), std::memory_order_release);
+    }
+};
+
+template<typename Cell>
+auto run(std::string_view name, std::size_t readers, bool swapping, std::chrono::milliseconds duration) -> bool {
+    std::atomic<bool> stop{false};
+    std::atomic<std::uint64_t> reads{0}, torn{0};
+    std::uint64_t swaps = 0;
+    {
+        Cell cell;
+        std::vector<std::thread> threads;
+        for (std::size_t r = 0; r < readers; ++r) {
+            threads.emplace_back([&] {
+                std::uint64_t local = 0, bad = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    bad += !cell.whole();
+                    ++local;
+                }
+                reads.fetch_add(local);
+                torn.fetch_add(bad);
+            });
+        }
+
+        auto until = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < until) {
+            if (swapping) {
+                cell.store(++swaps);
+            }
+            std::this_thread::yield();
+        }
+        stop.store(true);
+        for (auto &t: threads) {
+            t.join();
+        }
+        Epoch::synchronize();
+    }
+
+    /* The cell is gone and the limbo list drained: nothing may be left alive */
+    bool leak_free = Config::alive.load() == 0;
+    auto seconds = std::chrono::duration<double>(duration).count();
+    Bench::Row("rcu_cell").add("cell", name).add("readers", readers).add("swapping", swapping)
+            .add("reads_per_second", static_cast<double>(reads.load()) / seconds)
+            .add("swaps_per_second", static_cast<double>(swaps) / seconds)
+            .add("torn_reads", torn.load()).add("leak_free", leak_free);
+    return torn.load() == 0 && leak_free;
+}
+
+auto main(int argc, char **argv) -> int {
+    auto duration = std::chrono::milliseconds(Bench::count_arg(argc, argv, 1, 500));
+
+    std::vector<std::size_t> reader_counts{1, 2, 4};
+    for (std::size_t r = 8; r <= 2 * std::thread::hardware_concurrency(); r *= 2) {
+        reader_counts.push_back(r);
+    }
+
+    bool ok = true;
+    for (auto readers: reader_counts) {
+        for (bool swapping: {false, true}) {
+            ok &= run<RcuAdapter>("rcu", readers, swapping, duration);
+            ok &= run<SharedMutexAdapter>("shared_mutex", readers, swapping, duration);
+            ok &= run<AtomicSharedPtrAdapter>("atomic_shared_ptr", readers, swapping, duration);
+        }
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
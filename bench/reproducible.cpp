@@ -0,0 +1,78 @@
+/* Cost of Reproducible::Mode::Deterministic over Mode::Fast for Reproducible::sum and PrefixScan, on pools of
+   2 threads up to twice the hardware threads; also checks the deterministic bits do not move with the pool size.
+   Usage: bench_reproducible [n = 1e8] [repeats = 5] */
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "PrefixScan.tcc"
+#include "Reproducible.tcc"
+#include "bench/Bench.tcc"
+
+
+template<typename T>
+auto run(std::string_view type, std::size_t n, std::size_t repeats) -> bool {
+    auto const input = Bench::random_values<T>(n);
+    std::span<T const> in(input);
+    std::vector<T> out(n);
+
+    /* Threads taking part, caller included; a pool always has at least one worker */
+    std::size_t hardware = std::max(2u, std::thread::hardware_concurrency());
+    std::vector<std::size_t> pool_sizes{2, 4, 8, hardware, 2 * hardware};
+    std::ranges::sort(pool_sizes);
+    pool_sizes.erase(std::ranges::unique(pool_sizes).begin(), pool_sizes.end());
+
+    using Mode = Reproducible::Mode;
+    using Bits = std::conditional_t<sizeof(T) == 8, std::uint64_t, std::uint32_t>;
+    bool stable = true;
+    std::optional<T> deterministic_sum, deterministic_last;
+
+    for (auto threads: pool_sizes) {
+        ThreadPool pool(threads - 1);
+        double sum_seconds[2], scan_seconds[2];
+        for (auto mode: {Mode::Fast, Mode::Deterministic}) {
+            auto m = static_cast<std::size_t>(mode);
+            T total{};
+            sum_seconds[m] = Bench::best_seconds(repeats, [&] { total = Reproducible::sum(in, mode, pool); });
+            scan_seconds[m] = Bench::best_seconds(repeats, [&] {
+                PrefixScan<T>::inclusive(in, std::span<T>(out), T{}, mode, pool);
+            });
+
+            if (mode == Mode::Deterministic) {
+                /* Bitwise equal whatever the pool size */
+                stable &= std::bit_cast<Bits>(deterministic_sum.value_or(total)) == std::bit_cast<Bits>(total);
+                stable &= std::bit_cast<Bits>(deterministic_last.value_or(out.back())) ==
+                          std::bit_cast<Bits>(out.back());
+                deterministic_sum = total;
+                deterministic_last = out.back();
+            }
+        }
+
+        Bench::Row("reproducible").add("type", type).add("threads", pool.concurrency()).add("n", n)
+                .add("sum_fast_seconds", sum_seconds[0]).add("sum_deterministic_seconds", sum_seconds[1])
+                .add("sum_overhead", sum_seconds[1] / sum_seconds[0])
+                .add("scan_fast_seconds", scan_seconds[0]).add("scan_deterministic_seconds", scan_seconds[1])
+                .add("scan_overhead", scan_seconds[1] / scan_seconds[0]);
+    }
+
+    Bench::Row("reproducible").add("type", type).add("n", n).add("deterministic_bits_stable", stable);
+    return stable;
+}
+
+auto main(int argc, char **argv) -> int {
+    auto n = Bench::count_arg(argc, argv, 1, 100'000'000);
+    auto repeats = Bench::count_arg(argc, argv, 2, 5);
+
+    bool ok = run<double>("double", n, repeats);
+    ok &= run<float>("float", n, repeats);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,78 @@
+/* Startup latency of the threaded binary: fork, exec and wait for exit, against /bin/true as the floor every
+   process pays. Usage: bench_startup [runs = 1000] [binary = the threaded target of this build] */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "bench/Bench.tcc"
+
+#ifndef THREADED_BINARY
+#define THREADED_BINARY "./threaded"
+#endif
+
+
+#if defined(__linux__)
+
+/// @brief Wall time of one fork/exec/wait of path with stdout and stderr on /dev/null, or a negative value on failure
+auto spawn_seconds(char const *path) -> double {
+    auto start = std::chrono::steady_clock::now();
+    auto pid = fork();
+    if (pid == 0) {
+        auto null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        execl(path, path, static_cast<char *>(nullptr));
+        _exit(127);
+    }
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return -1;
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+auto run(std::string_view name, char const *path, std::size_t runs) -> bool {
+    std::vector<double> samples;
+    samples.reserve(runs);
+    for (std::size_t r = 0; r < runs; ++r) {
+        auto seconds = spawn_seconds(path);
+        if (seconds < 0) {
+            std::fprintf(stderr, "could not run %s\n", path);
+            return false;
+        }
+        samples.push_back(seconds);
+    }
+
+    Bench::Row("startup").add("binary", name).add("runs", runs)
+            .add("min_us", Bench::percentile(samples, 0) * 1e6)
+            .add("p50_us", Bench::percentile(samples, 50) * 1e6)
+            .add("p99_us", Bench::percentile(samples, 99) * 1e6);
+    return true;
+}
+
+auto main(int argc, char **argv) -> int {
+    auto runs = Bench::count_arg(argc, argv, 1, 1000);
+    char const *binary = argc > 2 ? argv[2] : THREADED_BINARY;
+
+    bool ok = run("true", "/bin/true", runs);
+    ok &= run("threaded", binary, runs);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#else
+
+auto main() -> int {
+    std::fprintf(stderr, "bench_startup needs fork/exec\n");
+    return EXIT_FAILURE;
+}
+
+#endif
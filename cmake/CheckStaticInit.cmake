@@ -0,0 +1,23 @@
+# Fails when BINARY runs code before main() to initialize namespace-scope objects.
+#
+# GCC and Clang emit one _GLOBAL__sub_I_<source> function for every translation unit that has a dynamic
+# initializer; constexpr/constinit globals never produce one.
+#
+# Usage: cmake -DNM=<nm> -DBINARY=<file> -P CheckStaticInit.cmake
+
+if (NOT NM OR NOT BINARY)
+    message(FATAL_ERROR "CheckStaticInit.cmake needs -DNM=<nm> and -DBINARY=<file>")
+endif ()
+
+execute_process(COMMAND ${NM} ${BINARY} OUTPUT_VARIABLE symbols RESULT_VARIABLE result ERROR_QUIET)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "Could not list the symbols of ${BINARY}")
+endif ()
+
+string(REGEX MATCHALL "_GLOBAL__sub_I_[A-Za-z0-9_.]+" initializers "${symbols}")
+if (initializers)
+    list(REMOVE_DUPLICATES initializers)
+    list(JOIN initializers "\n  " listing)
+    message(FATAL_ERROR "Dynamic initializers found in ${BINARY}:\n  ${listing}\n"
+            "Make the globals of these translation units constexpr or constinit.")
+endif ()
@@ -29,6 +29,14 @@
 #include <coroutine>
 #include <bitset>
 #include <map>
+#include <initializer_list>
+
+#include "ArithmeticMantissa.tcc"
+#include "ArithmeticRadix.tcc"
+#include "ConcurrentQueue.tcc"
+#include "EpochReclamation.tcc"
+#include "Instrumentation.tcc"
+#include "ThreadPool.tcc"
 
 
 /* Concept for a data structure that can be used as a container for a graph. */
@@ -82,6 +90,29 @@ public:
 };
 
 
+/* Value for objects too large for std::atomic (config blocks and the like): readers never lock, set() swaps in
+ * a new object and the old one is reclaimed once no reader can still see it */
+template<typename T>
+class SharedValue : public AbstractValue<T> {
+
+    RcuCell<T> cell;
+
+public:
+    explicit SharedValue(T t) : cell(std::move(t)) {}
+
+    T get() override { return cell.load(); }
+
+    void set(T t) override { cell.store(std::move(t)); }
+
+    /// @brief Pinned view of the current object, without copying it
+    auto read() const { return cell.read(); }
+
+    /// @brief Read-copy-update in place of get() + set(), so concurrent edits are not lost
+    template<typename F>
+    void update(F &&f) { cell.update(std::forward<F>(f)); }
+};
+
+
 /* Concept for a threaded data structure */
 template<typename T>
 concept ThreadableDataStructure = requires(T t) {
@@ -153,6 +184,27 @@ public:
 };
 
 
+/* TemplateFunction whose callable can be swapped while other threads are calling it */
+template<template<typename...> class T, typename... Args>
+class SwappableTemplateFunction {
+private:
+    RcuCell<std::function<T<Args...>(Args...)>> m_function;
+
+public:
+    explicit SwappableTemplateFunction(std::function<T<Args...>(Args...)> function) : m_function(std::move(function)) {}
+
+    /* Calls run the callable that was current when they started, even if it is replaced meanwhile */
+    T<Args...> operator()(Args... args) const {
+        auto function = m_function.read();
+        return (*function)(args...);
+    }
+
+    void set_function(std::function<T<Args...>(Args...)> function) {
+        m_function.store(std::move(function));
+    }
+};
+
+
 template<std::size_t NumThreads>
 class AbstractThreadedClass {
 
@@ -267,22 +319,44 @@ public:
     constexpr ThreadedClass(ThreadableDataStructure &data, T &func) : data(data), func(func) {}
 
     void operator()() {
+        Instrumentation::ScopedTimer timer(Instrumentation::Timer::ThreadedRun);
+        Instrumentation::add(Instrumentation::Counter::TasksRun);
         std::for_each(Exec, data.begin(), data.end(), func);
     }
-};
 
+    /// @brief Pool mode: like operator()() but chunked by ThreadPool::parallel_for, which tunes the grain to
+    /// func's measured cost and reports what it did
+    auto operator()(ThreadPool &pool, ParallelForOptions options = {}) -> ParallelForStats {
+        Instrumentation::ScopedTimer timer(Instrumentation::Timer::ThreadedRun);
+        Instrumentation::add(Instrumentation::Counter::TasksRun);
+        return pool.parallel_for(data, func, options);
+    }
 
-template<std::size_t Base = 2>
-class ArithmeticRadix {
-
+    /// @brief Streaming mode: NumThreads consumers (one for an SPSC queue) pop batches from the queue and apply
+    /// func to every element until the queue is closed and drained
+    template<typename V, QueueMode Mode>
+    void operator()(ConcurrentQueue<V, Mode> &queue, std::size_t batch = 64) {
+        Instrumentation::ScopedTimer timer(Instrumentation::Timer::ThreadedRun);
+
+        auto consume = [&] {
+            std::vector<V> items(std::max<std::size_t>(batch, 1));
+            for (auto n = queue.pop_batch(items); n != 0; n = queue.pop_batch(items)) {
+                Instrumentation::add(Instrumentation::Counter::TasksRun);
+                std::for_each(items.begin(), items.begin() + static_cast<std::ptrdiff_t>(n), func);
+            }
+        };
+
+        constexpr std::size_t consumers = Mode == QueueMode::SPSC ? 1 : NumThreads;
+        std::vector<std::jthread> workers;
+        workers.reserve(consumers - 1);
+        for (std::size_t t = 1; t < consumers; ++t) {
+            workers.emplace_back(consume);
+        }
+        consume();
+    }
 };
 
 
-template<std::size_t Base = 2>
-class ArithmeticMantissa {
-
-};
-
 template<typename T>
 class ArithmeticExponent {
 
@@ -822,259 +896,264 @@ using r15 = rd::Radix15;
 using r16 = rd::Radix16;
 
 
-std::vector<std::map<std::pair<std::size_t, std::size_t>, std::vector<SyntheticRadix>>> synthetic_radixes = {
+/* Fixed-capacity digit string, so the tables below need no heap storage and are constant-initialized */
+struct SyntheticDigits {
+    std::array<SyntheticRadix, 2> digits{};
+    std::size_t size = 0;
 
-        /* Radix Two */
-        {
-                {{2, 0}, {r2::ZERO}},
-                {{3, 0}, {r3::ZERO}},
-                {{4, 0}, {r4::ZERO}},
-                {{5, 0}, {r5::ZERO}},
-                {{6, 0}, {r6::ZERO}},
-                {{7, 0}, {r7::ZERO}},
-                {{8, 0}, {r8::ZERO}},
-                {{9, 0}, {r9::ZERO}},
-                {{10, 0}, {r10::ZERO}},
-                {{11, 0}, {r11::ZERO}},
-                {{12, 0}, {r12::ZERO}},
-                {{13, 0}, {r13::ZERO}},
-                {{14, 0}, {r14::ZERO}},
-                {{15, 0}, {r15::ZERO}},
-                {{16, 0}, {r16::ZERO}},
-
-                {{2, 1}, {r2::ONE}},
-                {{3, 1}, {r3::ONE}},
-                {{4, 1}, {r4::ONE}},
-                {{5, 1}, {r5::ONE}},
-                {{6, 1}, {r6::ONE}},
-                {{7, 1}, {r7::ONE}},
-                {{8, 1}, {r8::ONE}},
-                {{9, 1}, {r9::ONE}},
-                {{10, 1}, {r10::ONE}},
-                {{11, 1}, {r11::ONE}},
-                {{12, 1}, {r12::ONE}},
-                {{13, 1}, {r13::ONE}},
-                {{14, 1}, {r14::ONE}},
-                {{15, 1}, {r15::ONE}},
-                {{16, 1}, {r16::ONE}},
-
-                {{2, 2}, {r2::ONE, r2::ZERO}},
-                {{3, 2}, {r3::ZERO, r3::TWO}},
-                {{4, 2}, {r4::ZERO, r4::TWO}},
-                {{5, 2}, {r5::ZERO, r5::TWO}},
-                {{6, 2}, {r6::ZERO, r6::TWO}},
-                {{7, 2}, {r7::ZERO, r7::TWO}},
-                {{8, 2}, {r8::ZERO, r8::TWO}},
-                {{9, 2}, {r9::ZERO, r9::TWO}},
-                {{10, 2}, {r10::ZERO, r10::TWO}},
-                {{11, 2}, {r11::ZERO, r11::TWO}},
-                {{12, 2}, {r12::ZERO, r12::TWO}},
-                {{13, 2}, {r13::ZERO, r13::TWO}},
-                {{14, 2}, {r14::ZERO, r14::TWO}},
-                {{15, 2}, {r15::ZERO, r15::TWO}},
-                {{16, 2}, {r16::ZERO, r16::TWO}}
+    constexpr SyntheticDigits(std::initializer_list<SyntheticRadix> list) {
+        for (auto const &digit: list) {
+            digits[size++] = digit;
         }
+    }
+
+    constexpr auto begin() const noexcept { return digits.begin(); }
+
+    constexpr auto end() const noexcept { return digits.begin() + static_cast<std::ptrdiff_t>(size); }
+};
+
+
+/* One (radix, value) -> V row of a lookup table */
+template<typename V>
+struct RadixTableEntry {
+    std::pair<std::size_t, std::size_t> key;
+    V value;
 };
 
+
+/* Row for (radix, value) in table, or nullptr */
+template<typename V, std::size_t N>
+constexpr auto radix_lookup(std::array<RadixTableEntry<V>, N> const &table, std::size_t radix, std::size_t value)
+-> V const * {
+    for (auto const &entry: table) {
+        if (entry.key == std::pair{radix, value}) {
+            return &entry.value;
+        }
+    }
+    return nullptr;
+}
+
+
+constexpr auto synthetic_radixes = std::to_array<RadixTableEntry<SyntheticDigits>>({
+
+        /* Radix Two */
+        {{2, 0}, {r2::ZERO}},
+        {{3, 0}, {r3::ZERO}},
+        {{4, 0}, {r4::ZERO}},
+        {{5, 0}, {r5::ZERO}},
+        {{6, 0}, {r6::ZERO}},
+        {{7, 0}, {r7::ZERO}},
+        {{8, 0}, {r8::ZERO}},
+        {{9, 0}, {r9::ZERO}},
+        {{10, 0}, {r10::ZERO}},
+        {{11, 0}, {r11::ZERO}},
+        {{12, 0}, {r12::ZERO}},
+        {{13, 0}, {r13::ZERO}},
+        {{14, 0}, {r14::ZERO}},
+        {{15, 0}, {r15::ZERO}},
+        {{16, 0}, {r16::ZERO}},
+
+        {{2, 1}, {r2::ONE}},
+        {{3, 1}, {r3::ONE}},
+        {{4, 1}, {r4::ONE}},
+        {{5, 1}, {r5::ONE}},
+        {{6, 1}, {r6::ONE}},
+        {{7, 1}, {r7::ONE}},
+        {{8, 1}, {r8::ONE}},
+        {{9, 1}, {r9::ONE}},
+        {{10, 1}, {r10::ONE}},
+        {{11, 1}, {r11::ONE}},
+        {{12, 1}, {r12::ONE}},
+        {{13, 1}, {r13::ONE}},
+        {{14, 1}, {r14::ONE}},
+        {{15, 1}, {r15::ONE}},
+        {{16, 1}, {r16::ONE}},
+
+        {{2, 2}, {r2::ONE, r2::ZERO}},
+        {{3, 2}, {r3::ZERO, r3::TWO}},
+        {{4, 2}, {r4::ZERO, r4::TWO}},
+        {{5, 2}, {r5::ZERO, r5::TWO}},
+        {{6, 2}, {r6::ZERO, r6::TWO}},
+        {{7, 2}, {r7::ZERO, r7::TWO}},
+        {{8, 2}, {r8::ZERO, r8::TWO}},
+        {{9, 2}, {r9::ZERO, r9::TWO}},
+        {{10, 2}, {r10::ZERO, r10::TWO}},
+        {{11, 2}, {r11::ZERO, r11::TWO}},
+        {{12, 2}, {r12::ZERO, r12::TWO}},
+        {{13, 2}, {r13::ZERO, r13::TWO}},
+        {{14, 2}, {r14::ZERO, r14::TWO}},
+        {{15, 2}, {r15::ZERO, r15::TWO}},
+        {{16, 2}, {r16::ZERO, r16::TWO}}
+});
+
 // pair (radix, value_to_convert)
-std::vector<std::map<std::pair<std::size_t, std::size_t>,
-        SyntheticRadix>> radix_map = {
+constexpr auto radix_map = std::to_array<RadixTableEntry<SyntheticRadix>>({
 
         // radix 2
-        {
-                {{2,  0}, RadixData<std::size_t>::Radix2::ZERO},
-                {{2,  1}, RadixData<std::size_t>::Radix2::ONE}
-        },
+        {{2,  0}, RadixData<std::size_t>::Radix2::ZERO},
+        {{2,  1}, RadixData<std::size_t>::Radix2::ONE},
 
         // radix 3
-        {
-                {{3,  0}, RadixData<std::size_t>::Radix3::ZERO},
-                {{3,  1}, RadixData<std::size_t>::Radix3::ONE},
-                {{3,  2}, RadixData<std::size_t>::Radix3::TWO}
-        },
+        {{3,  0}, RadixData<std::size_t>::Radix3::ZERO},
+        {{3,  1}, RadixData<std::size_t>::Radix3::ONE},
+        {{3,  2}, RadixData<std::size_t>::Radix3::TWO},
 
         // radix 4
-        {
-                {{4,  0}, RadixData<std::size_t>::Radix4::ZERO},
-                {{4,  1}, RadixData<std::size_t>::Radix4::ONE},
-                {{4,  2}, RadixData<std::size_t>::Radix4::TWO},
-                {{4,  3}, RadixData<std::size_t>::Radix4::THREE}
-        },
+        {{4,  0}, RadixData<std::size_t>::Radix4::ZERO},
+        {{4,  1}, RadixData<std::size_t>::Radix4::ONE},
+        {{4,  2}, RadixData<std::size_t>::Radix4::TWO},
+        {{4,  3}, RadixData<std::size_t>::Radix4::THREE},
 
         // radix 5
-        {
-                {{5,  0}, RadixData<std::size_t>::Radix5::ZERO},
-                {{5,  1}, RadixData<std::size_t>::Radix5::ONE},
-                {{5,  2}, RadixData<std::size_t>::Radix5::TWO},
-                {{5,  3}, RadixData<std::size_t>::Radix5::THREE},
-                {{5,  4}, RadixData<std::size_t>::Radix5::FOUR}
-        },
+        {{5,  0}, RadixData<std::size_t>::Radix5::ZERO},
+        {{5,  1}, RadixData<std::size_t>::Radix5::ONE},
+        {{5,  2}, RadixData<std::size_t>::Radix5::TWO},
+        {{5,  3}, RadixData<std::size_t>::Radix5::THREE},
+        {{5,  4}, RadixData<std::size_t>::Radix5::FOUR},
 
         // radix 6
-        {
-                {{6,  0}, RadixData<std::size_t>::Radix6::ZERO},
-                {{6,  1}, RadixData<std::size_t>::Radix6::ONE},
-                {{6,  2}, RadixData<std::size_t>::Radix6::TWO},
-                {{6,  3}, RadixData<std::size_t>::Radix6::THREE},
-                {{6,  4}, RadixData<std::size_t>::Radix6::FOUR},
-                {{6,  5}, RadixData<std::size_t>::Radix6::FIVE}
-        },
+        {{6,  0}, RadixData<std::size_t>::Radix6::ZERO},
+        {{6,  1}, RadixData<std::size_t>::Radix6::ONE},
+        {{6,  2}, RadixData<std::size_t>::Radix6::TWO},
+        {{6,  3}, RadixData<std::size_t>::Radix6::THREE},
+        {{6,  4}, RadixData<std::size_t>::Radix6::FOUR},
+        {{6,  5}, RadixData<std::size_t>::Radix6::FIVE},
 
         // radix 7
-        {
-                {{7,  0}, RadixData<std::size_t>::Radix7::ZERO},
-                {{7,  1}, RadixData<std::size_t>::Radix7::ONE},
-                {{7,  2}, RadixData<std::size_t>::Radix7::TWO},
-                {{7,  3}, RadixData<std::size_t>::Radix7::THREE},
-                {{7,  4}, RadixData<std::size_t>::Radix7::FOUR},
-                {{7,  5}, RadixData<std::size_t>::Radix7::FIVE},
-                {{7,  6}, RadixData<std::size_t>::Radix7::SIX}
-        },
+        {{7,  0}, RadixData<std::size_t>::Radix7::ZERO},
+        {{7,  1}, RadixData<std::size_t>::Radix7::ONE},
+        {{7,  2}, RadixData<std::size_t>::Radix7::TWO},
+        {{7,  3}, RadixData<std::size_t>::Radix7::THREE},
+        {{7,  4}, RadixData<std::size_t>::Radix7::FOUR},
+        {{7,  5}, RadixData<std::size_t>::Radix7::FIVE},
+        {{7,  6}, RadixData<std::size_t>::Radix7::SIX},
 
         // radix 8
-        {
-                {{8,  0}, RadixData<std::size_t>::Radix8::ZERO},
-                {{8,  1}, RadixData<std::size_t>::Radix8::ONE},
-                {{8,  2}, RadixData<std::size_t>::Radix8::TWO},
-                {{8,  3}, RadixData<std::size_t>::Radix8::THREE},
-                {{8,  4}, RadixData<std::size_t>::Radix8::FOUR},
-                {{8,  5}, RadixData<std::size_t>::Radix8::FIVE},
-                {{8,  6}, RadixData<std::size_t>::Radix8::SIX},
-                {{8,  7}, RadixData<std::size_t>::Radix8::SEVEN}
-        },
+        {{8,  0}, RadixData<std::size_t>::Radix8::ZERO},
+        {{8,  1}, RadixData<std::size_t>::Radix8::ONE},
+        {{8,  2}, RadixData<std::size_t>::Radix8::TWO},
+        {{8,  3}, RadixData<std::size_t>::Radix8::THREE},
+        {{8,  4}, RadixData<std::size_t>::Radix8::FOUR},
+        {{8,  5}, RadixData<std::size_t>::Radix8::FIVE},
+        {{8,  6}, RadixData<std::size_t>::Radix8::SIX},
+        {{8,  7}, RadixData<std::size_t>::Radix8::SEVEN},
 
         // radix 9
-        {
-                {{9,  0}, RadixData<std::size_t>::Radix9::ZERO},
-                {{9,  1}, RadixData<std::size_t>::Radix9::ONE},
-                {{9,  2}, RadixData<std::size_t>::Radix9::TWO},
-                {{9,  3}, RadixData<std::size_t>::Radix9::THREE},
-                {{9,  4}, RadixData<std::size_t>::Radix9::FOUR},
-                {{9,  5}, RadixData<std::size_t>::Radix9::FIVE},
-                {{9,  6}, RadixData<std::size_t>::Radix9::SIX},
-                {{9,  7}, RadixData<std::size_t>::Radix9::SEVEN},
-                {{9,  8}, RadixData<std::size_t>::Radix9::EIGHT}
-        },
+        {{9,  0}, RadixData<std::size_t>::Radix9::ZERO},
+        {{9,  1}, RadixData<std::size_t>::Radix9::ONE},
+        {{9,  2}, RadixData<std::size_t>::Radix9::TWO},
+        {{9,  3}, RadixData<std::size_t>::Radix9::THREE},
+        {{9,  4}, RadixData<std::size_t>::Radix9::FOUR},
+        {{9,  5}, RadixData<std::size_t>::Radix9::FIVE},
+        {{9,  6}, RadixData<std::size_t>::Radix9::SIX},
+        {{9,  7}, RadixData<std::size_t>::Radix9::SEVEN},
+        {{9,  8}, RadixData<std::size_t>::Radix9::EIGHT},
 
         // radix 10
-        {
-                {{10, 0}, RadixData<std::size_t>::Radix10::ZERO},
-                {{10, 1}, RadixData<std::size_t>::Radix10::ONE},
-                {{10, 2}, RadixData<std::size_t>::Radix10::TWO},
-                {{10, 3}, RadixData<std::size_t>::Radix10::THREE},
-                {{10, 4}, RadixData<std::size_t>::Radix10::FOUR},
-                {{10, 5}, RadixData<std::size_t>::Radix10::FIVE},
-                {{10, 6}, RadixData<std::size_t>::Radix10::SIX},
-                {{10, 7}, RadixData<std::size_t>::Radix10::SEVEN},
-                {{10, 8}, RadixData<std::size_t>::Radix10::EIGHT},
-                {{10, 9}, RadixData<std::size_t>::Radix10::NINE}
-        },
+        {{10, 0}, RadixData<std::size_t>::Radix10::ZERO},
+        {{10, 1}, RadixData<std::size_t>::Radix10::ONE},
+        {{10, 2}, RadixData<std::size_t>::Radix10::TWO},
+        {{10, 3}, RadixData<std::size_t>::Radix10::THREE},
+        {{10, 4}, RadixData<std::size_t>::Radix10::FOUR},
+        {{10, 5}, RadixData<std::size_t>::Radix10::FIVE},
+        {{10, 6}, RadixData<std::size_t>::Radix10::SIX},
+        {{10, 7}, RadixData<std::size_t>::Radix10::SEVEN},
+        {{10, 8}, RadixData<std::size_t>::Radix10::EIGHT},
+        {{10, 9}, RadixData<std::size_t>::Radix10::NINE},
 
         // radix 11
-        {
-                {{11, 0}, RadixData<std::size_t>::Radix11::ZERO},
-                {{11, 1}, RadixData<std::size_t>::Radix11::ONE},
-                {{11, 2}, RadixData<std::size_t>::Radix11::TWO},
-                {{11, 3}, RadixData<std::size_t>::Radix11::THREE},
-                {{11, 4}, RadixData<std::size_t>::Radix11::FOUR},
-                {{11, 5}, RadixData<std::size_t>::Radix11::FIVE},
-                {{11, 6}, RadixData<std::size_t>::Radix11::SIX},
-                {{11, 7}, RadixData<std::size_t>::Radix11::SEVEN},
-                {{11, 8}, RadixData<std::size_t>::Radix11::EIGHT},
-                {{11, 9}, RadixData<std::size_t>::Radix11::NINE},
-                {{11, 10}, RadixData<std::size_t>::Radix11::TEN}
-        },
+        {{11, 0}, RadixData<std::size_t>::Radix11::ZERO},
+        {{11, 1}, RadixData<std::size_t>::Radix11::ONE},
+        {{11, 2}, RadixData<std::size_t>::Radix11::TWO},
+        {{11, 3}, RadixData<std::size_t>::Radix11::THREE},
+        {{11, 4}, RadixData<std::size_t>::Radix11::FOUR},
+        {{11, 5}, RadixData<std::size_t>::Radix11::FIVE},
+        {{11, 6}, RadixData<std::size_t>::Radix11::SIX},
+        {{11, 7}, RadixData<std::size_t>::Radix11::SEVEN},
+        {{11, 8}, RadixData<std::size_t>::Radix11::EIGHT},
+        {{11, 9}, RadixData<std::size_t>::Radix11::NINE},
+        {{11, 10}, RadixData<std::size_t>::Radix11::TEN},
 
         // radix 12
-        {
-                {{12, 0}, RadixData<std::size_t>::Radix12::ZERO},
-                {{12, 1}, RadixData<std::size_t>::Radix12::ONE},
-                {{12, 2}, RadixData<std::size_t>::Radix12::TWO},
-                {{12, 3}, RadixData<std::size_t>::Radix12::THREE},
-                {{12, 4}, RadixData<std::size_t>::Radix12::FOUR},
-                {{12, 5}, RadixData<std::size_t>::Radix12::FIVE},
-                {{12, 6}, RadixData<std::size_t>::Radix12::SIX},
-                {{12, 7}, RadixData<std::size_t>::Radix12::SEVEN},
-                {{12, 8}, RadixData<std::size_t>::Radix12::EIGHT},
-                {{12, 9}, RadixData<std::size_t>::Radix12::NINE},
-                {{12, 10}, RadixData<std::size_t>::Radix12::TEN},
-                {{12, 11}, RadixData<std::size_t>::Radix12::ELEVEN}
-        },
+        {{12, 0}, RadixData<std::size_t>::Radix12::ZERO},
+        {{12, 1}, RadixData<std::size_t>::Radix12::ONE},
+        {{12, 2}, RadixData<std::size_t>::Radix12::TWO},
+        {{12, 3}, RadixData<std::size_t>::Radix12::THREE},
+        {{12, 4}, RadixData<std::size_t>::Radix12::FOUR},
+        {{12, 5}, RadixData<std::size_t>::Radix12::FIVE},
+        {{12, 6}, RadixData<std::size_t>::Radix12::SIX},
+        {{12, 7}, RadixData<std::size_t>::Radix12::SEVEN},
+        {{12, 8}, RadixData<std::size_t>::Radix12::EIGHT},
+        {{12, 9}, RadixData<std::size_t>::Radix12::NINE},
+        {{12, 10}, RadixData<std::size_t>::Radix12::TEN},
+        {{12, 11}, RadixData<std::size_t>::Radix12::ELEVEN},
 
         // radix 13
-        {
-                {{13, 0}, RadixData<std::size_t>::Radix13::ZERO},
-                {{13, 1}, RadixData<std::size_t>::Radix13::ONE},
-                {{13, 2}, RadixData<std::size_t>::Radix13::TWO},
-                {{13, 3}, RadixData<std::size_t>::Radix13::THREE},
-                {{13, 4}, RadixData<std::size_t>::Radix13::FOUR},
-                {{13, 5}, RadixData<std::size_t>::Radix13::FIVE},
-                {{13, 6}, RadixData<std::size_t>::Radix13::SIX},
-                {{13, 7}, RadixData<std::size_t>::Radix13::SEVEN},
-                {{13, 8}, RadixData<std::size_t>::Radix13::EIGHT},
-                {{13, 9}, RadixData<std::size_t>::Radix13::NINE},
-                {{13, 10}, RadixData<std::size_t>::Radix13::TEN},
-                {{13, 11}, RadixData<std::size_t>::Radix13::ELEVEN},
-                {{13, 12}, RadixData<std::size_t>::Radix13::TWELVE}
-        },
+        {{13, 0}, RadixData<std::size_t>::Radix13::ZERO},
+        {{13, 1}, RadixData<std::size_t>::Radix13::ONE},
+        {{13, 2}, RadixData<std::size_t>::Radix13::TWO},
+        {{13, 3}, RadixData<std::size_t>::Radix13::THREE},
+        {{13, 4}, RadixData<std::size_t>::Radix13::FOUR},
+        {{13, 5}, RadixData<std::size_t>::Radix13::FIVE},
+        {{13, 6}, RadixData<std::size_t>::Radix13::SIX},
+        {{13, 7}, RadixData<std::size_t>::Radix13::SEVEN},
+        {{13, 8}, RadixData<std::size_t>::Radix13::EIGHT},
+        {{13, 9}, RadixData<std::size_t>::Radix13::NINE},
+        {{13, 10}, RadixData<std::size_t>::Radix13::TEN},
+        {{13, 11}, RadixData<std::size_t>::Radix13::ELEVEN},
+        {{13, 12}, RadixData<std::size_t>::Radix13::TWELVE},
 
         // radix 14
-        {
-                {{14, 0}, RadixData<std::size_t>::Radix14::ZERO},
-                {{14, 1}, RadixData<std::size_t>::Radix14::ONE},
-                {{14, 2}, RadixData<std::size_t>::Radix14::TWO},
-                {{14, 3}, RadixData<std::size_t>::Radix14::THREE},
-                {{14, 4}, RadixData<std::size_t>::Radix14::FOUR},
-                {{14, 5}, RadixData<std::size_t>::Radix14::FIVE},
-                {{14, 6}, RadixData<std::size_t>::Radix14::SIX},
-                {{14, 7}, RadixData<std::size_t>::Radix14::SEVEN},
-                {{14, 8}, RadixData<std::size_t>::Radix14::EIGHT},
-                {{14, 9}, RadixData<std::size_t>::Radix14::NINE},
-                {{14, 10}, RadixData<std::size_t>::Radix14::TEN},
-                {{14, 11}, RadixData<std::size_t>::Radix14::ELEVEN},
-                {{14, 12}, RadixData<std::size_t>::Radix14::TWELVE},
-                {{14, 13}, RadixData<std::size_t>::Radix14::THIRTEEN}
-        },
+        {{14, 0}, RadixData<std::size_t>::Radix14::ZERO},
+        {{14, 1}, RadixData<std::size_t>::Radix14::ONE},
+        {{14, 2}, RadixData<std::size_t>::Radix14::TWO},
+        {{14, 3}, RadixData<std::size_t>::Radix14::THREE},
+        {{14, 4}, RadixData<std::size_t>::Radix14::FOUR},
+        {{14, 5}, RadixData<std::size_t>::Radix14::FIVE},
+        {{14, 6}, RadixData<std::size_t>::Radix14::SIX},
+        {{14, 7}, RadixData<std::size_t>::Radix14::SEVEN},
+        {{14, 8}, RadixData<std::size_t>::Radix14::EIGHT},
+        {{14, 9}, RadixData<std::size_t>::Radix14::NINE},
+        {{14, 10}, RadixData<std::size_t>::Radix14::TEN},
+        {{14, 11}, RadixData<std::size_t>::Radix14::ELEVEN},
+        {{14, 12}, RadixData<std::size_t>::Radix14::TWELVE},
+        {{14, 13}, RadixData<std::size_t>::Radix14::THIRTEEN},
 
         // radix 15
-        {
-                {{15, 0}, RadixData<std::size_t>::Radix15::ZERO},
-                {{15, 1}, RadixData<std::size_t>::Radix15::ONE},
-                {{15, 2}, RadixData<std::size_t>::Radix15::TWO},
-                {{15, 3}, RadixData<std::size_t>::Radix15::THREE},
-                {{15, 4}, RadixData<std::size_t>::Radix15::FOUR},
-                {{15, 5}, RadixData<std::size_t>::Radix15::FIVE},
-                {{15, 6}, RadixData<std::size_t>::Radix15::SIX},
-                {{15, 7}, RadixData<std::size_t>::Radix15::SEVEN},
-                {{15, 8}, RadixData<std::size_t>::Radix15::EIGHT},
-                {{15, 9}, RadixData<std::size_t>::Radix15::NINE},
-                {{15, 10}, RadixData<std::size_t>::Radix15::TEN},
-                {{15, 11}, RadixData<std::size_t>::Radix15::ELEVEN},
-                {{15, 12}, RadixData<std::size_t>::Radix15::TWELVE},
-                {{15, 13}, RadixData<std::size_t>::Radix15::THIRTEEN},
-                {{15, 14}, RadixData<std::size_t>::Radix15::FOURTEEN}
-        },
+        {{15, 0}, RadixData<std::size_t>::Radix15::ZERO},
+        {{15, 1}, RadixData<std::size_t>::Radix15::ONE},
+        {{15, 2}, RadixData<std::size_t>::Radix15::TWO},
+        {{15, 3}, RadixData<std::size_t>::Radix15::THREE},
+        {{15, 4}, RadixData<std::size_t>::Radix15::FOUR},
+        {{15, 5}, RadixData<std::size_t>::Radix15::FIVE},
+        {{15, 6}, RadixData<std::size_t>::Radix15::SIX},
+        {{15, 7}, RadixData<std::size_t>::Radix15::SEVEN},
+        {{15, 8}, RadixData<std::size_t>::Radix15::EIGHT},
+        {{15, 9}, RadixData<std::size_t>::Radix15::NINE},
+        {{15, 10}, RadixData<std::size_t>::Radix15::TEN},
+        {{15, 11}, RadixData<std::size_t>::Radix15::ELEVEN},
+        {{15, 12}, RadixData<std::size_t>::Radix15::TWELVE},
+        {{15, 13}, RadixData<std::size_t>::Radix15::THIRTEEN},
+        {{15, 14}, RadixData<std::size_t>::Radix15::FOURTEEN},
 
         // radix 16
-        {
-                {{16, 0}, RadixData<std::size_t>::Radix16::ZERO},
-                {{16, 1}, RadixData<std::size_t>::Radix16::ONE},
-                {{16, 2}, RadixData<std::size_t>::Radix16::TWO},
-                {{16, 3}, RadixData<std::size_t>::Radix16::THREE},
-                {{16, 4}, RadixData<std::size_t>::Radix16::FOUR},
-                {{16, 5}, RadixData<std::size_t>::Radix16::FIVE},
-                {{16, 6}, RadixData<std::size_t>::Radix16::SIX},
-                {{16, 7}, RadixData<std::size_t>::Radix16::SEVEN},
-                {{16, 8}, RadixData<std::size_t>::Radix16::EIGHT},
-                {{16, 9}, RadixData<std::size_t>::Radix16::NINE},
-                {{16, 10}, RadixData<std::size_t>::Radix16::TEN},
-                {{16, 11}, RadixData<std::size_t>::Radix16::ELEVEN},
-                {{16, 12}, RadixData<std::size_t>::Radix16::TWELVE},
-                {{16, 13}, RadixData<std::size_t>::Radix16::THIRTEEN},
-                {{16, 14}, RadixData<std::size_t>::Radix16::FOURTEEN},
-                {{16, 15}, RadixData<std::size_t>::Radix16::FIFTEEN}
-        },
-};
+        {{16, 0}, RadixData<std::size_t>::Radix16::ZERO},
+        {{16, 1}, RadixData<std::size_t>::Radix16::ONE},
+        {{16, 2}, RadixData<std::size_t>::Radix16::TWO},
+        {{16, 3}, RadixData<std::size_t>::Radix16::THREE},
+        {{16, 4}, RadixData<std::size_t>::Radix16::FOUR},
+        {{16, 5}, RadixData<std::size_t>::Radix16::FIVE},
+        {{16, 6}, RadixData<std::size_t>::Radix16::SIX},
+        {{16, 7}, RadixData<std::size_t>::Radix16::SEVEN},
+        {{16, 8}, RadixData<std::size_t>::Radix16::EIGHT},
+        {{16, 9}, RadixData<std::size_t>::Radix16::NINE},
+        {{16, 10}, RadixData<std::size_t>::Radix16::TEN},
+        {{16, 11}, RadixData<std::size_t>::Radix16::ELEVEN},
+        {{16, 12}, RadixData<std::size_t>::Radix16::TWELVE},
+        {{16, 13}, RadixData<std::size_t>::Radix16::THIRTEEN},
+        {{16, 14}, RadixData<std::size_t>::Radix16::FOURTEEN},
+        {{16, 15}, RadixData<std::size_t>::Radix16::FIFTEEN}
+});
 
 
 template<typename T>
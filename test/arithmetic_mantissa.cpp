@@ -0,0 +1,57 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "ArithmeticMantissa.tcc"
+
+
+/* Self-addition: the operand aliases *this, inline and spilled to the heap, for both signs */
+
+using Mantissa = ArithmeticMantissa<10>;
+
+auto expect(char const *what, Mantissa const &got, std::string const &expected) -> bool {
+    auto text = got.to_string();
+    bool ok = text == expected;
+    std::printf("{\"case\": \"%s\", \"got\": \"%s\", \"expected\": \"%s\", \"passed\": %s}\n", what, text.c_str(),
+                expected.c_str(), ok ? "true" : "false");
+    return ok;
+}
+
+/// @brief x += x, x + x and x -= x against the same operations on an equal but separate object
+auto check(char const *what, Mantissa const &x) -> bool {
+    Mantissa copy = x;
+    bool passed = true;
+
+    Mantissa doubled = x;
+    doubled += doubled;
+    passed &= expect((std::string(what) + " x += x").c_str(), doubled, (x + copy).to_string());
+
+    passed &= expect((std::string(what) + " x + x").c_str(), x + x, (Mantissa(x) += copy).to_string());
+
+    Mantissa zero = x;
+    zero -= zero;
+    passed &= expect((std::string(what) + " x -= x").c_str(), zero, "0");
+    return passed;
+}
+
+int main() {
+    bool passed = true;
+
+    /* The carry out of the top limb is what the aliased add used to lose */
+    Mantissa top(std::uint64_t{1} << 63);
+    Mantissa self = top;
+    self += self;
+    passed &= expect("2^63 += itself", self, "18446744073709551616");
+
+    passed &= check("one limb", Mantissa(std::uint64_t{1} << 63));
+    passed &= check("two limbs", Mantissa(~static_cast<unsigned __int128>(0)));
+    passed &= check("negative", Mantissa(-static_cast<__int128>(~static_cast<unsigned __int128>(0) >> 1)));
+
+    /* Three limbs, so the value lives on the heap */
+    Mantissa wide = Mantissa(~static_cast<unsigned __int128>(0)) * Mantissa(~std::uint64_t{0});
+    passed &= check("heap", wide);
+    passed &= check("zero", Mantissa());
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
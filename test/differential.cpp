@@ -0,0 +1,43 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "Differential.tcc"
+
+
+/* Every type/policy pair Differential can check: NaN is floating point only, Throw returns no value, and each
+   of these types has a wider counterpart for Widen */
+
+template<Differential::Checkable T, OverflowPolicy Policy>
+auto check(char const *type, char const *policy, bool &first) -> bool {
+    auto report = Differential::run<T, Policy>();
+    std::printf("%s{\"type\": \"%s\", \"policy\": \"%s\", \"report\": %s}", first ? "" : ",\n", type, policy,
+                report.to_json().c_str());
+    first = false;
+    return report.passed();
+}
+
+template<Differential::Checkable T>
+auto check_all(char const *type, bool &first) -> bool {
+    bool passed = true;
+    passed &= check<T, OverflowPolicy::Saturate>(type, "saturate", first);
+    passed &= check<T, OverflowPolicy::Widen>(type, "widen", first);
+    passed &= check<T, OverflowPolicy::Wrap>(type, "wrap", first);
+    if constexpr (std::is_floating_point_v<T>) {
+        passed &= check<T, OverflowPolicy::NaN>(type, "nan", first);
+    }
+    return passed;
+}
+
+int main() {
+    bool first = true;
+    bool passed = true;
+    std::printf("[");
+    passed &= check_all<double>("double", first);
+    passed &= check_all<float>("float", first);
+    passed &= check_all<std::int32_t>("int32", first);
+    passed &= check_all<std::int64_t>("int64", first);
+    passed &= check_all<std::uint8_t>("uint8", first);
+    std::printf("]\n");
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}